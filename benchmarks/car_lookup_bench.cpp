@@ -0,0 +1,83 @@
+// Car lookup by id as the fleet grows: the old linear find_if over the car list against
+// CarRentalSystem::getCarById, which goes through the id -> slot index.
+// Build: g++ -std=c++17 -O2 -pthread -DCAR_RENTAL_NO_MAIN benchmarks/car_lookup_bench.cpp -o car_lookup_bench
+// Runs in a scratch directory under the system temp dir, since the system keeps its data files in the cwd.
+#include <random>
+
+#include "../merged_project.cpp"
+
+// The lookup getCarById did before the index: a scan for the first car with that id
+const Car &findLinear(const vector<Car> &cars, int carId)
+{
+    auto it = find_if(cars.begin(), cars.end(), [carId](const Car &car)
+                      { return car.getId() == carId; });
+    if (it == cars.end())
+    {
+        throw CarNotFoundException();
+    }
+    return *it;
+}
+
+// Mean nanoseconds per call of lookup(id) over random ids in [1, fleet]
+template <typename Lookup>
+double nanosPerLookup(size_t fleet, size_t lookups, Lookup lookup)
+{
+    mt19937 rng(7);
+    uniform_int_distribution<int> pick(1, static_cast<int>(fleet));
+    vector<int> ids(lookups);
+    for (int &id : ids)
+    {
+        id = pick(rng);
+    }
+    double checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int id : ids)
+    {
+        checksum += lookup(id);
+    }
+    double nanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    if (checksum < 0)
+    {
+        cout << checksum; // keeps the loop from being optimized away
+    }
+    return nanos / lookups;
+}
+
+int main()
+{
+    filesystem::path scratch = filesystem::temp_directory_path() / "car_lookup_bench";
+    filesystem::remove_all(scratch);
+    filesystem::create_directories(scratch);
+    filesystem::current_path(scratch);
+
+    CarRentalSystem &system = *CarRentalSystem::getInstance();
+    vector<Car> linear;
+    system.forEachAvailableCar([&linear](const Car &car)
+                               { linear.push_back(car); });
+
+    cout << setw(8) << "fleet" << setw(16) << "find_if (ns)" << setw(18) << "getCarById (ns)\n";
+    for (size_t fleet : {100, 1000, 10000, 100000})
+    {
+        while (linear.size() < fleet)
+        {
+            int carId = system.getNextCarId();
+            Car car(carId, "Brand" + to_string(carId % 40), "Model" + to_string(carId % 300), "Sedan", 2020,
+                    "Blue", 40 + carId % 60, "REG" + to_string(carId));
+            system.addCar(car);
+            linear.push_back(car);
+        }
+        // Fewer scans on big fleets: each one walks half the list on average
+        size_t scans = max<size_t>(200, 2000000 / fleet);
+        double scan = nanosPerLookup(fleet, scans, [&linear](int id)
+                                     { return findLinear(linear, id).getPricePerDay(); });
+        double indexed = nanosPerLookup(fleet, 200000, [&system](int id)
+                                        { return system.getCarById(id).getPricePerDay(); });
+        cout << setw(8) << fleet << setw(16) << fixed << setprecision(0) << scan << setw(17) << indexed << "\n";
+    }
+
+    system.waitForCompaction();
+    Logger::getInstance()->shutdown();
+    filesystem::current_path(scratch.parent_path());
+    filesystem::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,195 @@
+// Cold start on a large cars.dat and users.dat. Times the old per-line istringstream loader
+// against the mapped string_view/from_chars one, first for parsing alone, then with the Car
+// and User objects built, then a full CarRentalSystem start (which also builds every index).
+// Build: g++ -std=c++17 -O2 -pthread -DCAR_RENTAL_NO_MAIN benchmarks/cold_start_bench.cpp -o cold_start_bench
+// Usage: cold_start_bench [cars] [users]. Runs in a scratch directory under the system temp dir.
+#include "../merged_project.cpp"
+
+double millisSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// The loader as it was: a stream and a token vector per line, stoi/stod per number
+template <typename Record>
+void loadWithStreams(const string &filename, Record record)
+{
+    ifstream inFile(filename);
+    string line;
+    while (getline(inFile, line))
+    {
+        istringstream iss(line);
+        string token;
+        vector<string> tokens;
+        while (getline(iss, token, ','))
+        {
+            tokens.push_back(token);
+        }
+        record(tokens);
+    }
+}
+
+// The current loader's parsing: views into the mapped file, from_chars for numbers
+template <size_t N, typename Record>
+void loadMapped(const string &filename, Record record)
+{
+    MappedFile file(filename);
+    forEachLine(file, [&record](string_view line)
+                {
+                    array<string_view, N> fields;
+                    size_t count = min(splitFields(line, fields), fields.size());
+                    record(fields, count); });
+}
+
+struct Timing
+{
+    double streams;
+    double mapped;
+};
+
+Timing parseOnly()
+{
+    Timing timing;
+    double checksum = 0;
+    auto start = chrono::steady_clock::now();
+    loadWithStreams("cars.dat", [&checksum](const vector<string> &tokens)
+                    {
+                        if (tokens.size() >= 8)
+                        {
+                            checksum += stoi(tokens[0]) + stoi(tokens[4]) + stod(tokens[6]) + tokens[7].size();
+                        } });
+    loadWithStreams("users.dat", [&checksum](const vector<string> &tokens)
+                    {
+                        if (tokens.size() == 5)
+                        {
+                            checksum += stoi(tokens[0]) + tokens[1].size();
+                        } });
+    timing.streams = millisSince(start);
+
+    double mappedChecksum = 0;
+    start = chrono::steady_clock::now();
+    loadMapped<9>("cars.dat", [&mappedChecksum](const array<string_view, 9> &fields, size_t count)
+                  {
+                      int id, year;
+                      double price;
+                      if (count >= 8 && parseNumber(fields[0], id) && parseNumber(fields[4], year) &&
+                          parseNumber(fields[6], price))
+                      {
+                          mappedChecksum += id + year + price + fields[7].size();
+                      } });
+    loadMapped<5>("users.dat", [&mappedChecksum](const array<string_view, 5> &fields, size_t count)
+                  {
+                      int id;
+                      if (count == 5 && parseNumber(fields[0], id))
+                      {
+                          mappedChecksum += id + fields[1].size();
+                      } });
+    timing.mapped = millisSince(start);
+    if (checksum != mappedChecksum)
+    {
+        cerr << "Loaders disagree: " << checksum << " vs " << mappedChecksum << endl;
+    }
+    return timing;
+}
+
+Timing withObjects(size_t carCount, size_t userCount)
+{
+    Timing timing;
+    {
+        vector<Car> cars;
+        vector<unique_ptr<User>> users;
+        auto start = chrono::steady_clock::now();
+        loadWithStreams("cars.dat", [&cars](const vector<string> &tokens)
+                        {
+                            if (tokens.size() >= 8)
+                            {
+                                cars.emplace_back(stoi(tokens[0]), tokens[1], tokens[2], tokens[3], stoi(tokens[4]),
+                                                  tokens[5], stod(tokens[6]), tokens[7]);
+                            } });
+        loadWithStreams("users.dat", [&users](const vector<string> &tokens)
+                        {
+                            if (tokens.size() == 5)
+                            {
+                                users.push_back(make_unique<Customer>(stoi(tokens[0]), tokens[1], tokens[2], tokens[3]));
+                            } });
+        timing.streams = millisSince(start);
+    }
+    {
+        vector<Car> cars;
+        vector<unique_ptr<User>> users;
+        auto start = chrono::steady_clock::now();
+        cars.reserve(carCount);
+        users.reserve(userCount);
+        loadMapped<9>("cars.dat", [&cars](const array<string_view, 9> &fields, size_t count)
+                      {
+                          int id, year;
+                          double price;
+                          if (count >= 8 && parseNumber(fields[0], id) && parseNumber(fields[4], year) &&
+                              parseNumber(fields[6], price))
+                          {
+                              cars.emplace_back(id, string(fields[1]), string(fields[2]), string(fields[3]), year,
+                                                string(fields[5]), price, string(fields[7]));
+                          } });
+        loadMapped<5>("users.dat", [&users](const array<string_view, 5> &fields, size_t count)
+                      {
+                          int id;
+                          if (count == 5 && parseNumber(fields[0], id))
+                          {
+                              users.push_back(make_unique<Customer>(id, string(fields[1]), string(fields[2]),
+                                                                    string(fields[3])));
+                          } });
+        timing.mapped = millisSince(start);
+    }
+    return timing;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t carCount = argc > 1 ? stoul(argv[1]) : 1000000;
+    size_t userCount = argc > 2 ? stoul(argv[2]) : 300000;
+
+    filesystem::path scratch = filesystem::temp_directory_path() / "cold_start_bench";
+    filesystem::remove_all(scratch);
+    filesystem::create_directories(scratch);
+    filesystem::current_path(scratch);
+    {
+        const vector<string> brands = {"Toyota", "Honda", "Ford", "Chevrolet", "Nissan", "Hyundai", "Kia", "Mazda"};
+        ofstream cars("cars.dat");
+        for (size_t i = 1; i <= carCount; ++i)
+        {
+            cars << Car(static_cast<int>(i), brands[i % brands.size()], "Model" + to_string(i % 500), "Sedan",
+                        2000 + static_cast<int>(i % 25), "Blue", 20.0 + i % 200, "REG" + to_string(i))
+                        .serialize()
+                 << '\n';
+        }
+        ofstream users("users.dat");
+        users << Admin(1, "admin", "admin123", "admin@carrental.com").serialize() << '\n';
+        for (size_t i = 2; i <= userCount; ++i)
+        {
+            users << Customer(static_cast<int>(i), "user" + to_string(i), "secret" + to_string(i),
+                              "user" + to_string(i) + "@example.com")
+                         .serialize()
+                  << '\n';
+        }
+    }
+
+    cout << carCount << " cars, " << userCount << " users\n";
+    auto report = [](const string &phase, Timing timing)
+    {
+        cout << left << setw(26) << phase << right << fixed << setprecision(0) << setw(8) << timing.streams
+             << " ms -> " << setw(6) << timing.mapped << " ms  (" << setprecision(1)
+             << timing.streams / timing.mapped << "x)\n";
+    };
+    report("parse only", parseOnly());
+    report("parse + Car/User objects", withObjects(carCount, userCount));
+
+    auto start = chrono::steady_clock::now();
+    CarRentalSystem::getInstance();
+    cout << "full CarRentalSystem start (parse, objects and all indexes): " << setprecision(0)
+         << millisSince(start) << " ms\n";
+
+    Logger::getInstance()->shutdown();
+    filesystem::current_path(scratch.parent_path());
+    filesystem::remove_all(scratch);
+    return 0;
+}
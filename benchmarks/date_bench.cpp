@@ -0,0 +1,104 @@
+// Day counts between two YYYY-MM-DD strings: the old calculateDaysBetweenDates (two
+// istringstreams, get_time, mktime) against Date::parse and day-number subtraction, on
+// 20k random pairs. Both are checked against a timegm (UTC, no DST) reference; Date must
+// match it on every pair, and the old function's disagreements are reported.
+// Build: g++ -std=c++17 -O2 -pthread -DCAR_RENTAL_NO_MAIN benchmarks/date_bench.cpp -o date_bench
+// Usage: date_bench [time zone], default America/New_York
+#include <cstdlib>
+#include <random>
+
+#include "../merged_project.cpp"
+
+// The function Booking durations used to go through
+int calculateDaysBetweenDates(const std::string &startDate, const std::string &endDate)
+{
+    std::tm start = {}, end = {};
+    std::istringstream ssStart(startDate);
+    std::istringstream ssEnd(endDate);
+
+    ssStart >> std::get_time(&start, "%Y-%m-%d");
+    ssEnd >> std::get_time(&end, "%Y-%m-%d");
+
+    if (ssStart.fail() || ssEnd.fail())
+    {
+        throw std::runtime_error("Invalid date format! Use YYYY-MM-DD.");
+    }
+
+    std::time_t startTime = std::mktime(&start);
+    std::time_t endTime = std::mktime(&end);
+    double secondsDiff = std::difftime(endTime, startTime);
+    return static_cast<int>(secondsDiff / (60 * 60 * 24));
+}
+
+// Whole days between two dates in UTC, where every day is 86400 s
+int referenceDays(int startYear, int startMonth, int startDay, int endYear, int endMonth, int endDay)
+{
+    tm start = {};
+    start.tm_year = startYear - 1900;
+    start.tm_mon = startMonth - 1;
+    start.tm_mday = startDay;
+    tm end = {};
+    end.tm_year = endYear - 1900;
+    end.tm_mon = endMonth - 1;
+    end.tm_mday = endDay;
+    return static_cast<int>((timegm(&end) - timegm(&start)) / 86400);
+}
+
+int main(int argc, char *argv[])
+{
+    setenv("TZ", argc > 1 ? argv[1] : "America/New_York", 1);
+    tzset();
+
+    // Years mktime handles everywhere; any day of each month
+    mt19937 rng(7);
+    const size_t pairCount = 20000;
+    vector<pair<string, string>> pairs;
+    vector<int> expected;
+    for (size_t i = 0; i < pairCount; ++i)
+    {
+        int ends[2][3];
+        for (auto &date : ends)
+        {
+            date[0] = 1971 + static_cast<int>(rng() % 66);
+            date[1] = 1 + static_cast<int>(rng() % 12);
+            date[2] = 1 + static_cast<int>(rng() % Date::daysInMonth(date[0], static_cast<unsigned>(date[1])));
+        }
+        auto text = [](const int *date)
+        {
+            ostringstream out;
+            out << date[0] << '-' << setw(2) << setfill('0') << date[1] << '-' << setw(2) << setfill('0') << date[2];
+            return out.str();
+        };
+        pairs.emplace_back(text(ends[0]), text(ends[1]));
+        expected.push_back(referenceDays(ends[0][0], ends[0][1], ends[0][2], ends[1][0], ends[1][1], ends[1][2]));
+    }
+
+    long long checksum = 0;
+    int oldWrong = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        int days = calculateDaysBetweenDates(pairs[i].first, pairs[i].second);
+        oldWrong += days != expected[i];
+        checksum += days;
+    }
+    double oldNanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / pairCount;
+
+    int newWrong = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        int days = Date::parse(pairs[i].second) - Date::parse(pairs[i].first);
+        newWrong += days != expected[i];
+        checksum += days;
+    }
+    double newNanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / pairCount;
+
+    cout << pairCount << " random pairs, TZ=" << getenv("TZ") << " (checksum " << checksum << ")\n";
+    cout << fixed << setprecision(1);
+    cout << "calculateDaysBetweenDates: " << setw(8) << oldNanos << " ns/pair, " << oldWrong
+         << " off the UTC day count\n";
+    cout << "Date::parse + subtract:    " << setw(8) << newNanos << " ns/pair, " << newWrong
+         << " off the UTC day count (" << oldNanos / newNanos << "x faster)\n";
+    return newWrong ? 1 : 0;
+}
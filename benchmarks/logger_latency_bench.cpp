@@ -0,0 +1,99 @@
+// Per-event logging latency seen by the calling thread: the old path, which opened, appended
+// to and closed the log file under one mutex for every event, against the Logger's ring and
+// writer thread. Prints p50/p99/p99.9/max per thread count.
+// Build: g++ -std=c++17 -O2 -pthread -DCAR_RENTAL_NO_MAIN benchmarks/logger_latency_bench.cpp -o logger_latency_bench
+// Usage: logger_latency_bench [events per thread]. Runs in a scratch directory under the system temp dir.
+#include "../merged_project.cpp"
+
+mutex oldLogMutex;
+
+// writeToLog as it was before the writer thread
+void logPasswordChangeDirect(const string &username, const string &email)
+{
+    PasswordChangeEvent event;
+    event.timestamp = getCurrentDate();
+    event.username = username;
+    event.email = email;
+    string content = event.toJson();
+
+    lock_guard<mutex> lock(oldLogMutex);
+    ofstream outFile("bookings_direct.jsonl", ios::app);
+    if (!outFile)
+    {
+        cerr << "Error: Could not open log file: bookings_direct.jsonl" << endl;
+        return;
+    }
+    outFile << content;
+}
+
+// Nanoseconds of every call of log(thread, i), from all threads together
+template <typename Log>
+vector<double> latencies(int threadCount, int events, Log log)
+{
+    vector<vector<double>> perThread(threadCount);
+    vector<thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&perThread, &log, t, events]
+                             {
+                                 vector<double> &samples = perThread[t];
+                                 samples.reserve(events);
+                                 for (int i = 0; i < events; ++i)
+                                 {
+                                     auto start = chrono::steady_clock::now();
+                                     log(t, i);
+                                     samples.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+                                 } });
+    }
+    for (thread &worker : threads)
+    {
+        worker.join();
+    }
+    vector<double> all;
+    for (const vector<double> &samples : perThread)
+    {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    sort(all.begin(), all.end());
+    return all;
+}
+
+void report(const string &path, int threadCount, const vector<double> &sorted)
+{
+    auto at = [&sorted](double fraction)
+    {
+        return sorted[min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))] / 1000;
+    };
+    cout << left << setw(22) << path << right << setw(3) << threadCount << fixed << setprecision(1) << setw(10)
+         << at(0.5) << setw(10) << at(0.99) << setw(10) << at(0.999) << setw(11) << sorted.back() / 1000 << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    int events = argc > 1 ? stoi(argv[1]) : 20000;
+
+    filesystem::path scratch = filesystem::temp_directory_path() / "logger_latency_bench";
+    filesystem::remove_all(scratch);
+    filesystem::create_directories(scratch);
+    filesystem::current_path(scratch);
+    Logger &logger = *Logger::getInstance();
+
+    cout << events << " password-change events per thread; latency in microseconds\n";
+    cout << left << setw(22) << "path" << right << setw(3) << "thr" << setw(10) << "p50" << setw(10) << "p99"
+         << setw(10) << "p99.9" << setw(11) << "max" << "\n";
+    for (int threadCount : {1, 4, 8})
+    {
+        report("open/append/close", threadCount, latencies(threadCount, events, [](int t, int i)
+                                                            { logPasswordChangeDirect("user" + to_string(t),
+                                                                                      "user" + to_string(i) + "@example.com"); }));
+        report("ring + writer thread", threadCount, latencies(threadCount, events, [&logger](int t, int i)
+                                                               { logger.logPasswordChange("user" + to_string(t),
+                                                                                          "user" + to_string(i) + "@example.com"); }));
+        logger.flush();
+    }
+
+    logger.shutdown();
+    filesystem::current_path(scratch.parent_path());
+    filesystem::remove_all(scratch);
+    return 0;
+}
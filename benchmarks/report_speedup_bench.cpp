@@ -0,0 +1,117 @@
+// Report rebuild time against worker threads: rebuildReportAggregates over a large
+// synthetic transaction and booking log, from one worker up to twice the hardware threads.
+// Every run must produce the same totals as the single-worker one.
+// Build: g++ -std=c++17 -O2 -pthread -DCAR_RENTAL_NO_MAIN benchmarks/report_speedup_bench.cpp -o report_speedup_bench
+// Usage: report_speedup_bench [transactions]. Runs in a scratch directory under the system temp dir.
+#include "../merged_project.cpp"
+
+void writeLogs(size_t transactionCount)
+{
+    const vector<string> methods = {"Credit Card", "PayPal", "Cash"};
+    ofstream transactions("transactions.jsonl");
+    ofstream bookings("bookings.jsonl");
+    for (size_t i = 1; i <= transactionCount; ++i)
+    {
+        int id = static_cast<int>(i);
+        TransactionEvent event;
+        event.timestamp = "2025-" + string(i % 12 < 9 ? "0" : "") + to_string(i % 12 + 1) + "-15 10:00:00";
+        event.username = "user" + to_string(i % 5000);
+        event.email = event.username + "@example.com";
+        event.carId = id % 2000;
+        event.carName = "Brand" + to_string(id % 40) + " Model" + to_string(id % 300);
+        event.carType = "Sedan";
+        event.registration = "REG" + to_string(id % 2000);
+        event.bookingId = id;
+        event.startDate = "2025-01-01";
+        event.endDate = "2025-01-04";
+        event.days = 3;
+        event.paymentId = id;
+        event.amount = 30.0 + i % 200;
+        event.method = methods[i % methods.size()];
+        event.status = "Completed";
+        event.transactionId = "TXN" + to_string(i);
+        transactions << event.toJson();
+
+        BookingEvent update;
+        update.timestamp = event.timestamp;
+        update.action = "Booking Approved";
+        update.username = event.username;
+        update.bookingId = id;
+        update.carName = event.carName;
+        update.status = "Approved";
+        bookings << update.toJson();
+    }
+}
+
+// Shards sum amounts in a different order, so compare them to a relative tolerance
+bool sameGroups(const map<string, GroupTotals> &a, const map<string, GroupTotals> &b)
+{
+    return a.size() == b.size() &&
+           equal(a.begin(), a.end(), b.begin(), [](const auto &x, const auto &y)
+                 { return x.first == y.first && x.second.count == y.second.count &&
+                          abs(x.second.amount - y.second.amount) <= 1e-9 * max(1.0, abs(y.second.amount)); });
+}
+
+bool sameTotals(const ReportAggregates &a, const ReportAggregates &b)
+{
+    return sameGroups(a.byMethod, b.byMethod) && sameGroups(a.byStatus, b.byStatus) &&
+           sameGroups(a.byMonth, b.byMonth) && sameGroups(a.byCar, b.byCar) &&
+           sameGroups(a.byCustomer, b.byCustomer);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t transactionCount = argc > 1 ? stoul(argv[1]) : 1000000;
+
+    filesystem::path scratch = filesystem::temp_directory_path() / "report_speedup_bench";
+    filesystem::remove_all(scratch);
+    filesystem::create_directories(scratch);
+    filesystem::current_path(scratch);
+    writeLogs(transactionCount);
+    Logger &logger = *Logger::getInstance();
+
+    size_t hardware = max(1u, thread::hardware_concurrency());
+    cout << transactionCount << " transactions, "
+         << ((filesystem::file_size("transactions.jsonl") + filesystem::file_size("bookings.jsonl")) >> 20)
+         << " MiB of logs, " << hardware << " hardware thread(s)\n";
+    cout << setw(8) << "workers" << setw(8) << "shards" << setw(12) << "ms" << setw(10) << "speedup\n";
+
+    double baseline = 0;
+    ReportAggregates expected;
+    int mismatches = 0;
+    for (size_t workers = 1; workers <= 2 * hardware; workers *= 2)
+    {
+        vector<double> runs;
+        size_t shards = 0;
+        for (int run = 0; run < 3; ++run)
+        {
+            auto start = chrono::steady_clock::now();
+            shards = logger.rebuildReportAggregates(workers);
+            runs.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        }
+        sort(runs.begin(), runs.end());
+        double millis = runs[1];
+        ReportAggregates totals = logger.getReportAggregates();
+        if (workers == 1)
+        {
+            baseline = millis;
+            expected = totals;
+        }
+        else if (!sameTotals(totals, expected))
+        {
+            ++mismatches;
+        }
+        cout << setw(8) << workers << setw(8) << shards << setw(12) << fixed << setprecision(1) << millis
+             << setw(9) << setprecision(2) << baseline / millis << "x\n";
+    }
+
+    logger.shutdown();
+    filesystem::current_path(scratch.parent_path());
+    filesystem::remove_all(scratch);
+    if (mismatches)
+    {
+        cerr << mismatches << " worker count(s) disagreed with the single-worker totals" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Date claims on one car's schedule: cost per claim as the schedule grows, and many threads
+// racing for the same days on a hot car (exactly one must win each slot).
+// Build: g++ -std=c++17 -O2 -pthread -DCAR_RENTAL_NO_MAIN benchmarks/reservation_contention.cpp -o reservation_contention
+// Usage: reservation_contention [threads]
+#include "../merged_project.cpp"
+
+// Nanoseconds per claim when the car already holds 'existing' reservations
+double claimNanos(int existing)
+{
+    ScheduleCell cell;
+    for (int i = 0; i < existing; ++i)
+    {
+        cell.claim(3 * i, 3 * i + 2, i + 1);
+    }
+    const int claims = 2000;
+    int first = 3 * existing;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < claims; ++i)
+    {
+        cell.claim(first + 3 * i, first + 3 * i + 2, existing + i + 1);
+    }
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / claims;
+}
+
+int main(int argc, char *argv[])
+{
+    int threadCount = argc > 1 ? stoi(argv[1]) : 8;
+
+    for (int existing : {0, 100, 1000, 10000})
+    {
+        cout << "claim with " << setw(5) << existing << " reservations held: " << fixed << setprecision(0)
+             << claimNanos(existing) << " ns\n";
+    }
+
+    // Every thread tries every slot; overlapping slot pairs make neighbours clash too
+    const int slots = 20000;
+    ScheduleCell hot;
+    vector<atomic<int>> winners(slots);
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&hot, &winners, t]
+                             {
+                                 for (int slot = 0; slot < slots; ++slot)
+                                 {
+                                     if (hot.claim(3 * slot, 3 * slot + 2 + 2 * (slot % 2), slot * 64 + t + 1))
+                                     {
+                                         ++winners[slot];
+                                     }
+                                 } });
+    }
+    for (thread &worker : threads)
+    {
+        worker.join();
+    }
+    double millis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    // An odd slot runs into the next slot's first day, so exactly one of each such pair wins
+    int broken = winners[0] != 1;
+    for (int slot = 1; slot < slots; slot += 2)
+    {
+        int pair = winners[slot] + (slot + 1 < slots ? winners[slot + 1].load() : 0);
+        broken += pair != 1;
+    }
+    cout << threadCount << " threads racing for " << slots << " slots on one car: " << setprecision(1) << millis
+         << " ms, " << setprecision(0) << threadCount * slots / millis << " claims/ms, " << broken
+         << " slot(s) with a wrong number of winners\n";
+    return broken ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+// Heap allocations per car search as the fleet grows, counted with a replacement operator
+// new. The old path copied every available car into a vector and then the matches into a
+// second one; findCars and forEachAvailableCar should allocate the same small number of
+// times whatever the fleet size, i.e. nothing per car.
+// Build: g++ -std=c++17 -O2 -pthread -DCAR_RENTAL_NO_MAIN benchmarks/search_alloc_bench.cpp -o search_alloc_bench
+// Runs in a scratch directory under the system temp dir, since the system keeps its data files in the cwd.
+#include <cstdlib>
+
+#include "../merged_project.cpp"
+
+// Only the measuring thread counts, so the log writer cannot skew the numbers
+thread_local bool counting = false;
+thread_local size_t allocations = 0;
+thread_local size_t allocatedBytes = 0;
+
+void *operator new(size_t size)
+{
+    if (counting)
+    {
+        ++allocations;
+        allocatedBytes += size;
+    }
+    if (void *memory = malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw bad_alloc();
+}
+
+// Out of line, or GCC sees free() inlined against operator new and warns
+[[gnu::noinline]] void operator delete(void *memory) noexcept { free(memory); }
+[[gnu::noinline]] void operator delete(void *memory, size_t) noexcept { free(memory); }
+
+// Car as it was: six strings, copied out by every getter
+class OldCar
+{
+private:
+    int id;
+    string brand;
+    string model;
+    string type;
+    int year;
+    string color;
+    double pricePerDay;
+    bool available;
+    string registrationNumber;
+    string status;
+
+public:
+    explicit OldCar(const Car &car)
+        : id(car.getId()), brand(car.getBrand()), model(car.getModel()), type(car.getType()), year(car.getYear()),
+          color(car.getColor()), pricePerDay(car.getPricePerDay()), available(true),
+          registrationNumber(car.getRegistrationNumber()), status("Available") {}
+
+    string getBrand() const { return brand; }
+    bool isAvailable() const { return available; }
+};
+
+// The old brand search: getAllAvailableCars, then copy_if into filteredCars
+size_t oldBrandSearch(const vector<OldCar> &cars, string brand)
+{
+    vector<OldCar> availableCars;
+    copy_if(cars.begin(), cars.end(), back_inserter(availableCars), [](const OldCar &car)
+            { return car.isAvailable(); });
+    transform(brand.begin(), brand.end(), brand.begin(), ::tolower);
+    vector<OldCar> filteredCars;
+    copy_if(availableCars.begin(), availableCars.end(), back_inserter(filteredCars), [&brand](const OldCar &car)
+            {
+                string carBrand = car.getBrand();
+                transform(carBrand.begin(), carBrand.end(), carBrand.begin(), ::tolower);
+                return carBrand.find(brand) != string::npos; });
+    return filteredCars.size();
+}
+
+struct Count
+{
+    size_t allocations;
+    size_t bytes;
+};
+
+template <typename Search>
+Count countAllocations(Search search)
+{
+    allocations = allocatedBytes = 0;
+    counting = true;
+    size_t hits = search();
+    counting = false;
+    if (hits == 0)
+    {
+        cerr << "search found nothing" << endl;
+    }
+    return {allocations, allocatedBytes};
+}
+
+int main()
+{
+    filesystem::path scratch = filesystem::temp_directory_path() / "search_alloc_bench";
+    filesystem::remove_all(scratch);
+    filesystem::create_directories(scratch);
+    filesystem::current_path(scratch);
+
+    CarRentalSystem &system = *CarRentalSystem::getInstance();
+    const vector<string> brands = {"Toyota", "Honda", "Ford", "Chevrolet", "Nissan", "Hyundai", "Kia", "Mazda"};
+    vector<OldCar> oldCars;
+    system.forEachAvailableCar([&oldCars](const Car &car)
+                               { oldCars.emplace_back(car); });
+
+    CarQuery brandQuery; // indexed: every Toyota
+    brandQuery.brand = "toyota";
+    CarQuery pricePage; // column scan, first page of ten, cheapest first
+    pricePage.minPrice = 40;
+    pricePage.maxPrice = 120;
+    pricePage.sortBy = CarQuery::SortBy::Price;
+    pricePage.limit = 10;
+
+    cout << "allocations (bytes) per search\n";
+    cout << setw(8) << "fleet" << setw(28) << "old copy + copy_if" << setw(24) << "findCars brand"
+         << setw(24) << "findCars price page" << setw(24) << "forEachAvailableCar\n";
+    for (size_t fleet : {1000, 10000, 100000})
+    {
+        while (oldCars.size() < fleet)
+        {
+            int carId = system.getNextCarId();
+            Car car(carId, brands[carId % brands.size()], "Model" + to_string(carId % 300), "Sedan", 2020, "Blue",
+                    20 + carId % 150, "REG" + to_string(carId));
+            system.addCar(car);
+            oldCars.emplace_back(car);
+        }
+        auto show = [](Count count, int width)
+        {
+            string cell = to_string(count.allocations) + " (" + to_string(count.bytes) + ")";
+            cout << setw(width) << cell;
+        };
+        cout << setw(8) << fleet;
+        show(countAllocations([&oldCars]
+                              { return oldBrandSearch(oldCars, "Toyota"); }),
+             28);
+        show(countAllocations([&system, &brandQuery]
+                              { return system.findCars(brandQuery).total; }),
+             24);
+        show(countAllocations([&system, &pricePage]
+                              { return system.findCars(pricePage).total; }),
+             24);
+        show(countAllocations([&system]
+                              {
+                                  size_t seen = 0;
+                                  system.forEachAvailableCar([&seen](const Car &car)
+                                                             { seen += car.getPricePerDay() > 0; });
+                                  return seen; }),
+             23);
+        cout << "\n";
+    }
+
+    system.waitForCompaction();
+    Logger::getInstance()->shutdown();
+    filesystem::current_path(scratch.parent_path());
+    filesystem::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Search index latency on a synthetic 1M-car catalog.
+// Build: g++ -std=c++17 -O2 -pthread -DCAR_RENTAL_NO_MAIN benchmarks/search_bench.cpp -o search_bench
+#include <random>
+
+#include "../merged_project.cpp"
+
+// Median wall time of one query over several runs, in milliseconds
+double medianMillis(const CarSearchIndex &index, const CarQuery &query, size_t &hits)
+{
+    vector<double> runs;
+    for (int run = 0; run < 15; ++run)
+    {
+        vector<int> carIds;
+        auto start = chrono::steady_clock::now();
+        index.candidates(query, carIds, numeric_limits<size_t>::max());
+        runs.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        hits = carIds.size();
+    }
+    sort(runs.begin(), runs.end());
+    return runs[runs.size() / 2];
+}
+
+int main(int argc, char *argv[])
+{
+    size_t fleet = argc > 1 ? stoul(argv[1]) : 1000000;
+    const vector<string> brands = {"Toyota", "Honda", "Ford", "Chevrolet", "Nissan", "Hyundai", "Kia", "Mazda",
+                                   "Subaru", "Volkswagen", "BMW", "Mercedes", "Audi", "Lexus", "Tesla", "Volvo"};
+    const vector<string> types = {"Sedan", "SUV", "Truck", "Van", "Coupe"};
+    const vector<string> colors = {"Black", "White", "Silver", "Red", "Blue", "Grey"};
+    mt19937 rng(42);
+
+    CarSearchIndex index;
+    string probe;
+    auto build = chrono::steady_clock::now();
+    for (size_t i = 1; i <= fleet; ++i)
+    {
+        string registration;
+        for (int c = 0; c < 3; ++c)
+        {
+            registration += char('A' + rng() % 26);
+        }
+        registration += to_string(100 + rng() % 900);
+        string model = "Model" + to_string(rng() % 500);
+        index.add(Car(static_cast<int>(i), brands[rng() % brands.size()], model, types[rng() % types.size()],
+                      2000 + static_cast<int>(rng() % 25), colors[rng() % colors.size()], 20.0 + rng() % 200,
+                      registration));
+        if (i == fleet / 2)
+        {
+            probe = registration;
+        }
+    }
+    cout << "Indexed " << fleet << " cars in "
+         << chrono::duration<double>(chrono::steady_clock::now() - build).count() << " s\n";
+
+    string typo = probe;
+    typo[1] = typo[1] == 'Z' ? 'Y' : char(typo[1] + 1);
+    struct Case
+    {
+        string name;
+        CarQuery query;
+    };
+    vector<Case> cases(7);
+    cases[0].name = "brand substring 'toyo'";
+    cases[0].query.brand = "toyo";
+    cases[1].name = "brand fuzzy 'Toyta'";
+    cases[1].query.brand = "Toyta";
+    cases[1].query.fuzzy = true;
+    cases[2].name = "keyword model 'model42'";
+    cases[2].query.keyword = "model42";
+    cases[3].name = "keyword registration '" + probe + "'";
+    cases[3].query.keyword = probe;
+    cases[4].name = "keyword fuzzy registration '" + typo + "'";
+    cases[4].query.keyword = typo;
+    cases[4].query.fuzzy = true;
+    cases[5].name = "brand fuzzy 'aaaaaa'";
+    cases[5].query.brand = "aaaaaa";
+    cases[5].query.fuzzy = true;
+    cases[6].name = "keyword fuzzy 'zzzzzzzz'";
+    cases[6].query.keyword = "zzzzzzzz";
+    cases[6].query.fuzzy = true;
+
+    for (const Case &c : cases)
+    {
+        size_t hits = 0;
+        double millis = medianMillis(index, c.query, hits);
+        cout << left << setw(44) << c.name << fixed << setprecision(3) << millis << " ms  (" << hits << " hits)\n";
+    }
+    return 0;
+}
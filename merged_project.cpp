@@ -9,11 +9,30 @@
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 #include <fstream>
-#include <random>
 #include <chrono>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
 #include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <string_view>
+#include <charconv>
+#include <array>
+#include <optional>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -44,11 +63,23 @@ void pressEnterToContinue()
     cin.get();
 }
 
+// localtime() shares one static buffer between threads; this fills the caller's
+tm localTime(time_t when)
+{
+    tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &when);
+#else
+    localtime_r(&when, &local);
+#endif
+    return local;
+}
+
 // Helper function to get current date as string
 string getCurrentDate()
 {
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
+    tm local = localTime(time(0));
+    const tm *ltm = &local;
     stringstream ss;
     ss << 1900 + ltm->tm_year << "-"
        << setw(2) << setfill('0') << 1 + ltm->tm_mon << "-"
@@ -56,38 +87,130 @@ string getCurrentDate()
     return ss.str();
 }
 
-// Helper function to generate random IDs
-int generateRandomId()
+// Lowercased copy used for case-insensitive matching
+string toLowerCopy(string text)
+{
+    transform(text.begin(), text.end(), text.begin(), ::tolower);
+    return text;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+constexpr int daysFromCivil(int year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int>(dayOfEra) - 719468;
+}
+
+// Inverse of daysFromCivil
+constexpr void civilFromDays(int days, int &year, unsigned &month, unsigned &day)
 {
-    static mt19937 rng(chrono::steady_clock::now().time_since_epoch().count());
-    uniform_int_distribution<int> dist(1000, 9999);
-    return dist(rng);
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    year = static_cast<int>(yearOfEra) + era * 400 + (month <= 2);
 }
 
-int calculateDaysBetweenDates(const std::string &startDate, const std::string &endDate)
+// Calendar date held as a day number (days since 1970-01-01). Comparing dates and
+// counting the days between them are integer operations with no time zone involved.
+class Date
 {
-    std::tm start = {}, end = {};
-    std::istringstream ssStart(startDate);
-    std::istringstream ssEnd(endDate);
+private:
+    int days = 0;
+
+public:
+    constexpr Date() = default;
+    constexpr explicit Date(int dayNumber) : days(dayNumber) {}
+    constexpr Date(int year, unsigned month, unsigned day) : days(daysFromCivil(year, month, day)) {}
+
+    // Strict YYYY-MM-DD; false for anything else, including days past the end of the month
+    static bool tryParse(string_view text, Date &date)
+    {
+        if (text.size() != 10 || text[4] != '-' || text[7] != '-')
+        {
+            return false;
+        }
+        int digits[8];
+        static constexpr size_t positions[] = {0, 1, 2, 3, 5, 6, 8, 9};
+        for (size_t i = 0; i < 8; ++i)
+        {
+            digits[i] = text[positions[i]] - '0';
+            if (digits[i] < 0 || digits[i] > 9)
+            {
+                return false;
+            }
+        }
+        int year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+        unsigned month = static_cast<unsigned>(digits[4] * 10 + digits[5]);
+        unsigned day = static_cast<unsigned>(digits[6] * 10 + digits[7]);
+        if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month))
+        {
+            return false;
+        }
+        date = Date(year, month, day);
+        return true;
+    }
+
+    static Date parse(string_view text)
+    {
+        Date date;
+        if (!tryParse(text, date))
+        {
+            throw runtime_error("Invalid date format! Use YYYY-MM-DD.");
+        }
+        return date;
+    }
 
-    ssStart >> std::get_time(&start, "%Y-%m-%d");
-    ssEnd >> std::get_time(&end, "%Y-%m-%d");
+    static Date today()
+    {
+        tm ltm = localTime(time(0));
+        return Date(1900 + ltm.tm_year, static_cast<unsigned>(1 + ltm.tm_mon), static_cast<unsigned>(ltm.tm_mday));
+    }
+
+    static constexpr unsigned daysInMonth(int year, unsigned month)
+    {
+        constexpr unsigned lengths[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        return lengths[month - 1] + (month == 2 && leap ? 1 : 0);
+    }
+
+    constexpr int dayNumber() const { return days; }
 
-    if (ssStart.fail() || ssEnd.fail())
+    string toString() const
     {
-        throw std::runtime_error("Invalid date format! Use YYYY-MM-DD.");
+        int year;
+        unsigned month, day;
+        civilFromDays(days, year, month, day);
+        char text[32];
+        snprintf(text, sizeof(text), "%04d-%02u-%02u", year, month, day);
+        return text;
     }
 
-    // Convert std::tm to time_t
-    std::time_t startTime = std::mktime(&start);
-    std::time_t endTime = std::mktime(&end);
+    // Whole days from 'other' to this date
+    constexpr int operator-(Date other) const { return days - other.days; }
+    constexpr bool operator==(Date other) const { return days == other.days; }
+    constexpr bool operator!=(Date other) const { return days != other.days; }
+    constexpr bool operator<(Date other) const { return days < other.days; }
+    constexpr bool operator>(Date other) const { return days > other.days; }
+    constexpr bool operator<=(Date other) const { return days <= other.days; }
+};
 
-    // Calculate the difference in seconds
-    double secondsDiff = std::difftime(endTime, startTime);
+static_assert(Date(1970, 1, 1).dayNumber() == 0, "civil date math");
+static_assert(Date(2024, 3, 1) - Date(2024, 2, 28) == 2, "leap years count February 29");
 
-    // Convert seconds to days
-    return static_cast<int>(secondsDiff / (60 * 60 * 24));
+ostream &operator<<(ostream &out, Date date)
+{
+    return out << date.toString();
 }
+
 // Exception classes
 class InvalidInputException : public exception
 {
@@ -134,211 +257,3081 @@ public:
     }
 };
 
-// Strategy Pattern: Payment Strategy
-class PaymentStrategy
+class InvalidTransitionException : public exception
 {
-public:
-    virtual ~PaymentStrategy() = default;
-    virtual void pay(double amount) = 0;
-    virtual string getType() const = 0;
-};
+private:
+    string message;
 
-class CreditCardStrategy : public PaymentStrategy
-{
 public:
-    void pay(double amount) override
+    InvalidTransitionException(const string &from, const string &to)
+        : message("Cannot change status from " + from + " to " + to + "!") {}
+
+    const char *what() const noexcept override
     {
-        cout << "Paid " << fixed << setprecision(2) << amount << " via Credit Card\n";
+        return message.c_str();
     }
-    string getType() const override { return "Credit Card"; }
 };
 
-class PayPalStrategy : public PaymentStrategy
+// Read-only view of a whole file: mmap where available, one bulk read otherwise
+class MappedFile
 {
+private:
+    const char *bytes = nullptr;
+    size_t length = 0;
+    string buffer;
+#ifndef _WIN32
+    void *mapping = MAP_FAILED;
+#endif
+
 public:
-    void pay(double amount) override
+    explicit MappedFile(const string &filename)
     {
-        cout << "Paid " << fixed << setprecision(2) << amount << " via PayPal\n";
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                bytes = static_cast<const char *>(mapping);
+                length = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+        if (mapping != MAP_FAILED)
+        {
+            return;
+        }
+#endif
+        ifstream inFile(filename, ios::binary);
+        if (!inFile)
+        {
+            return;
+        }
+        buffer.assign(istreambuf_iterator<char>(inFile), istreambuf_iterator<char>());
+        bytes = buffer.data();
+        length = buffer.size();
     }
-    string getType() const override { return "PayPal"; }
-};
 
-class CashStrategy : public PaymentStrategy
-{
-public:
-    void pay(double amount) override
+    ~MappedFile()
     {
-        cout << "Paid " << fixed << setprecision(2) << amount << " in Cash\n";
+#ifndef _WIN32
+        if (mapping != MAP_FAILED)
+        {
+            munmap(mapping, length);
+        }
+#endif
     }
-    string getType() const override { return "Cash"; }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return bytes; }
+    size_t size() const { return length; }
 };
 
-// Car class
-class Car
+// Push a closed file's contents to disk, so a rename over the old copy cannot leave an
+// empty or partial file behind after a crash
+bool syncFile(const string &filename)
 {
-private:
-    int id;
-    string brand;
-    string model;
-    string type;
-    int year;
-    string color;
-    double pricePerDay;
-    bool available;
-    string registrationNumber;
-    string status;
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_WRONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+#else
+    return true;
+#endif
+}
 
-public:
-    Car(int id, const string &brand, const string &model, const string &type,
-        int year, const string &color, double pricePerDay, const string &regNum, bool available = true)
-        : id(id), brand(brand), model(model), type(type), year(year),
-          color(color), pricePerDay(pricePerDay), registrationNumber(regNum), available(available),
-          status("Available") {}
+// Visit each line of a buffer as a view into it (CRLF tolerant)
+template <typename Visitor>
+void forEachLine(string_view rest, Visitor &&visit)
+{
+    while (!rest.empty())
+    {
+        size_t end = rest.find('\n');
+        string_view line = rest.substr(0, end);
+        rest = (end == string_view::npos) ? string_view() : rest.substr(end + 1);
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        visit(line);
+    }
+}
 
-    // Getters
-    int getId() const { return id; }
-    string getBrand() const { return brand; }
-    string getModel() const { return model; }
-    string getType() const { return type; }
-    int getYear() const { return year; }
-    string getColor() const { return color; }
-    double getPricePerDay() const { return pricePerDay; }
-    bool isAvailable() const { return available; }
-    string getRegistrationNumber() const { return registrationNumber; }
-    string getStatus() const { return status; }
+template <typename Visitor>
+void forEachLine(const MappedFile &file, Visitor &&visit)
+{
+    forEachLine(string_view(file.data(), file.size()), visit);
+}
 
-    // Setters
-    void setPricePerDay(double price) { pricePerDay = price; }
-    void setAvailable(bool avail)
+// Stream the bytes [begin, end) of a file line by line through a fixed-size buffer.
+// Memory stays bounded by the chunk plus the longest line, however large the file grows.
+template <typename Visitor>
+void forEachLineInRange(const string &filename, uintmax_t begin, uintmax_t end, Visitor &&visit)
+{
+    ifstream inFile(filename, ios::binary);
+    if (!inFile)
     {
-        available = avail;
-        status = avail ? "Available" : "Rented";
+        return;
     }
-    void setStatus(const string &newStatus)
+    inFile.seekg(static_cast<streamoff>(begin));
+
+    constexpr size_t chunkSize = 64 * 1024;
+    unique_ptr<char[]> buffer(new char[chunkSize]);
+    string carry; // Partial line left over from the previous chunk
+    uintmax_t remaining = end - begin;
+    while (inFile && remaining > 0)
     {
-        status = newStatus;
-        available = (newStatus == "Available");
+        inFile.read(buffer.get(), static_cast<streamsize>(min<uintmax_t>(chunkSize, remaining)));
+        remaining -= static_cast<uintmax_t>(inFile.gcount());
+        string_view chunk(buffer.get(), static_cast<size_t>(inFile.gcount()));
+        if (chunk.empty())
+        {
+            break;
+        }
+
+        size_t first = chunk.find('\n');
+        if (first == string_view::npos)
+        {
+            carry.append(chunk);
+            continue;
+        }
+        carry.append(chunk.substr(0, first));
+        forEachLine(string_view(carry), visit);
+        carry.clear();
+
+        size_t last = chunk.rfind('\n');
+        forEachLine(chunk.substr(first + 1, last - first), visit);
+        carry.assign(chunk.substr(last + 1));
     }
+    forEachLine(string_view(carry), visit);
+}
 
-    void display() const
+template <typename Visitor>
+void forEachLineInFile(const string &filename, uintmax_t offset, Visitor &&visit)
+{
+    forEachLineInRange(filename, offset, numeric_limits<uintmax_t>::max(), visit);
+}
+
+// Split [begin, end) of a file into up to 'parts' ranges that each start on a line boundary
+inline vector<uintmax_t> lineAlignedSplits(const string &filename, uintmax_t begin, uintmax_t end, size_t parts)
+{
+    vector<uintmax_t> splits{begin};
+    ifstream inFile(filename, ios::binary);
+    for (size_t i = 1; inFile && i < parts; ++i)
     {
-        cout << "ID: " << id << " | " << year << " " << brand << " " << model
-             << " (" << color << ")\n"
-             << "Type: " << type << " | Reg: " << registrationNumber
-             << " | Price/Day: $" << fixed << setprecision(2) << pricePerDay
-             << " | Status: " << status << endl;
+        uintmax_t guess = max(splits.back(), begin + (end - begin) * i / parts);
+        inFile.seekg(static_cast<streamoff>(guess));
+        inFile.ignore(numeric_limits<streamsize>::max(), '\n');
+        if (!inFile)
+        {
+            break;
+        }
+        uintmax_t boundary = static_cast<uintmax_t>(inFile.tellg());
+        if (boundary >= end)
+        {
+            break;
+        }
+        if (boundary > splits.back())
+        {
+            splits.push_back(boundary);
+        }
     }
+    splits.push_back(end);
+    return splits;
+}
 
-    string serialize() const
+inline size_t countLines(const MappedFile &file)
+{
+    return static_cast<size_t>(count(file.data(), file.data() + file.size(), '\n'));
+}
+
+// Split a comma-separated record into views; returns N + 1 if there were more than N fields
+template <size_t N>
+size_t splitFields(string_view line, array<string_view, N> &fields)
+{
+    for (size_t count = 0; count < N; ++count)
     {
-        return to_string(id) + "," + brand + "," + model + "," + type + "," +
-               to_string(year) + "," + color + "," + to_string(pricePerDay) + "," +
-               registrationNumber + "," + status;
+        size_t comma = line.find(',');
+        fields[count] = line.substr(0, comma);
+        if (comma == string_view::npos)
+        {
+            return count + 1;
+        }
+        line.remove_prefix(comma + 1);
     }
+    return N + 1;
+}
+
+template <typename T>
+bool parseNumber(string_view text, T &value)
+{
+    return from_chars(text.data(), text.data() + text.size(), value).ec == errc();
+}
+
+// Fixed-width text field helpers for binary records
+template <size_t N>
+void copyField(char (&dest)[N], const string &value)
+{
+    size_t n = min(value.size(), N - 1);
+    memcpy(dest, value.data(), n);
+    memset(dest + n, 0, N - n);
+}
+
+template <size_t N>
+string fieldString(const char (&src)[N])
+{
+    return string(src, strnlen(src, N));
+}
+
+// On-disk layouts for the binary stores (first member is always the record id)
+struct BookingRecord
+{
+    int32_t id;
+    int32_t userId;
+    int32_t carId;
+    char startDate[11];
+    char endDate[11];
+    char status[16];
+    char bookingDate[11];
+    double totalPrice;
 };
 
-// Booking class
-class Booking
+struct PaymentRecord
+{
+    int32_t id;
+    int32_t bookingId;
+    double amount;
+    char date[11];
+    char status[16];
+    char method[16];
+    char transactionId[16];
+};
+
+// Append-only file of fixed-width records with an id -> slot index.
+// Appends and in-place updates are O(1); a torn trailing record is ignored on load.
+template <typename Record>
+class RecordStore
 {
 private:
-    int id;
-    int userId;
-    int carId;
-    string startDate;
-    string endDate;
-    string status;
-    double totalPrice;
-    string bookingDate;
+    string filename;
+    fstream file;
+    unordered_map<int, size_t> slots;
+    size_t count = 0;
 
-public:
-    Booking(int id, int userId, int carId, const string &startDate,
-            const string &endDate, double totalPrice, const string &status = "Pending")
-        : id(id), userId(userId), carId(carId), startDate(startDate),
-          endDate(endDate), totalPrice(totalPrice), status(status),
-          bookingDate(getCurrentDate()) {}
+    void openForWrite()
+    {
+        if (file.is_open())
+        {
+            return;
+        }
+        ofstream(filename, ios::binary | ios::app).close(); // Create if missing
+        file.open(filename, ios::binary | ios::in | ios::out);
+        if (!file)
+        {
+            cerr << "Error: Could not open record store: " << filename << endl;
+        }
+    }
 
-    // Getters
-    int getId() const { return id; }
-    int getUserId() const { return userId; }
-    int getCarId() const { return carId; }
-    string getStartDate() const { return startDate; }
-    string getEndDate() const { return endDate; }
-    string getStatus() const { return status; }
-    double getTotalPrice() const { return totalPrice; }
-    string getBookingDate() const { return bookingDate; }
+    void writeAt(size_t slot, const Record &record)
+    {
+        openForWrite();
+        file.seekp(static_cast<streamoff>(slot * sizeof(Record)));
+        file.write(reinterpret_cast<const char *>(&record), sizeof(Record));
+        file.flush();
+    }
 
-    // Setters
-    void setStatus(const string &newStatus)
+public:
+    explicit RecordStore(const string &filename) : filename(filename) {}
+
+    // Visit every stored record in slot order
+    template <typename Visitor>
+    void load(Visitor &&visit)
     {
-        if (newStatus == "Approved" || newStatus == "Rejected" ||
-            newStatus == "Pending" || newStatus == "Paid")
+        MappedFile mapped(filename);
+        count = mapped.size() / sizeof(Record);
+        for (size_t slot = 0; slot < count; ++slot)
         {
-            status = newStatus;
+            Record record;
+            memcpy(&record, mapped.data() + slot * sizeof(Record), sizeof(Record));
+            slots[record.id] = slot;
+            visit(record);
         }
     }
-    void setEndDate(const string &date) { endDate = date; }
 
-    void display() const
+    size_t append(const Record &record)
     {
-        cout << "Booking ID: " << id << "\n";
-        cout << "Status: " << status << "\n";
-        cout << "Dates: " << startDate << " to " << endDate << "\n";
-        cout << "Total Price: $" << fixed << setprecision(2) << totalPrice << "\n";
-        cout << "Booked on: " << bookingDate << "\n";
+        size_t slot = count++;
+        slots[record.id] = slot;
+        writeAt(slot, record);
+        return slot;
+    }
+
+    void update(const Record &record)
+    {
+        auto it = slots.find(record.id);
+        if (it == slots.end())
+        {
+            append(record);
+            return;
+        }
+        writeAt(it->second, record);
     }
 };
 
-// Payment class
-class Payment
+// Hands out unique, increasing ids that survive restarts. A 64-bit high-water mark is
+// persisted a block at a time under a lock; each thread then hands out ids from its own
+// leased block without locking. Ids left in a block when the program exits are skipped,
+// never reused. Ids are ints because the record stores hold 32-bit ids.
+class IdAllocator
 {
 private:
-    int id;
-    int bookingId;
-    double amount;
-    string date;
-    string status;
-    string method;
-    string transactionId;
+    struct Lease
+    {
+        uint64_t owner; // allocator serial, so a new allocator never reuses a stale lease
+        uint64_t next;
+        uint64_t end;
+    };
+
+    static constexpr uint64_t blockSize = 64;
+    string filename;
+    uint64_t serial;
+    mutex leaseMutex;
+    uint64_t highWater = 1; // every id below this has been leased
+
+    static uint64_t nextSerial()
+    {
+        static atomic<uint64_t> serials{0};
+        return ++serials;
+    }
+
+    // Persist the new mark before any id under it is handed out; throws runtime_error if it
+    // cannot be made durable
+    void saveHighWater()
+    {
+        const string tmpFile = filename + ".tmp";
+        {
+            ofstream out(tmpFile, ios::trunc);
+            if (!out || !(out << highWater << '\n') || !out.flush())
+            {
+                throw runtime_error("Could not save id counter: " + filename);
+            }
+        }
+        error_code ec;
+        if (!syncFile(tmpFile))
+        {
+            throw runtime_error("Could not sync id counter: " + filename);
+        }
+        filesystem::rename(tmpFile, filename, ec);
+        if (ec)
+        {
+            throw runtime_error("Could not replace id counter " + filename + ": " + ec.message());
+        }
+    }
+
+    Lease lease()
+    {
+        lock_guard<mutex> lock(leaseMutex);
+        if (highWater + blockSize > static_cast<uint64_t>(numeric_limits<int>::max()))
+        {
+            throw overflow_error("Id space exhausted: " + filename);
+        }
+        Lease block{serial, highWater, highWater + blockSize};
+        highWater = block.end;
+        saveHighWater();
+        return block;
+    }
 
 public:
-    Payment(int id, int bookingId, double amount, const string &method,
-            const string &status = "Completed")
-        : id(id), bookingId(bookingId), amount(amount), method(method),
-          status(status), date(getCurrentDate()), transactionId(to_string(generateRandomId())) {}
+    explicit IdAllocator(const string &filename) : filename(filename), serial(nextSerial())
+    {
+        MappedFile file(filename);
+        parseNumber(string_view(file.data(), file.size()), highWater);
+        highWater = max<uint64_t>(highWater, 1);
+    }
 
-    // Getters
-    int getId() const { return id; }
-    int getBookingId() const { return bookingId; }
+    // Never hand out anything below 'floor' (ids already on disk from older versions)
+    void reserveBelow(uint64_t floor)
+    {
+        lock_guard<mutex> lock(leaseMutex);
+        if (floor > highWater)
+        {
+            highWater = floor;
+            saveHighWater();
+        }
+    }
+
+    int next()
+    {
+        thread_local vector<Lease> leases; // one per allocator this thread has used
+        auto it = find_if(leases.begin(), leases.end(), [this](const Lease &held)
+                          { return held.owner == serial; });
+        if (it == leases.end())
+        {
+            leases.push_back(lease());
+            it = leases.end() - 1;
+        }
+        else if (it->next == it->end)
+        {
+            *it = lease();
+        }
+        return static_cast<int>(it->next++);
+    }
+};
+
+// Reader/writer lock over a set of tables: reads share it, writes hold it alone. A thread
+// already inside (a visitor callback that reads again, or a write that reads on the way)
+// passes straight through, since shared_mutex itself must not be locked twice. Asking to
+// write while only reading would deadlock, so it throws instead.
+class TableLock
+{
+private:
+    struct Held
+    {
+        const TableLock *lock;
+        size_t depth;
+        bool exclusive;
+    };
+
+    mutable shared_mutex tables;
+
+    static vector<Held> &heldByThread()
+    {
+        thread_local vector<Held> held;
+        return held;
+    }
+
+    Held *findHeld() const
+    {
+        for (auto &held : heldByThread())
+        {
+            if (held.lock == this)
+            {
+                return &held;
+            }
+        }
+        return nullptr;
+    }
+
+    void release() const
+    {
+        vector<Held> &held = heldByThread();
+        Held *mine = findHeld();
+        if (--mine->depth > 0)
+        {
+            return;
+        }
+        bool exclusive = mine->exclusive;
+        *mine = held.back();
+        held.pop_back();
+        if (exclusive)
+        {
+            tables.unlock();
+        }
+        else
+        {
+            tables.unlock_shared();
+        }
+    }
+
+public:
+    // Releases on scope exit
+    class Guard
+    {
+    private:
+        const TableLock *owner;
+
+    public:
+        explicit Guard(const TableLock *owner) : owner(owner) {}
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+        ~Guard() { owner->release(); }
+    };
+
+    Guard read() const
+    {
+        if (Held *mine = findHeld())
+        {
+            ++mine->depth;
+            return Guard(this);
+        }
+        tables.lock_shared();
+        heldByThread().push_back({this, 1, false});
+        return Guard(this);
+    }
+
+    Guard write()
+    {
+        if (Held *mine = findHeld())
+        {
+            if (!mine->exclusive)
+            {
+                throw logic_error("Cannot modify the tables from inside a read");
+            }
+            ++mine->depth;
+            return Guard(this);
+        }
+        tables.lock();
+        heldByThread().push_back({this, 1, true});
+        return Guard(this);
+    }
+};
+
+// Reserved date ranges for one car, kept disjoint and ordered by start day.
+// Ranges are half-open [start, end): a car returned on a date can go out again that day.
+class CarSchedule
+{
+private:
+    struct Reservation
+    {
+        int end;
+        int bookingId;
+    };
+    map<int, Reservation> reservations; // start day -> reservation
+
+public:
+    // O(log n): with disjoint ranges only the last one starting before 'end' can overlap
+    bool isFree(int start, int end) const
+    {
+        auto next = reservations.lower_bound(end);
+        if (next == reservations.begin())
+        {
+            return true;
+        }
+        --next;
+        return next->second.end <= start;
+    }
+
+    void reserve(int start, int end, int bookingId)
+    {
+        reservations[start] = Reservation{end, bookingId};
+    }
+
+    // Calls fn(start, end) for every reservation overlapping [from, to)
+    template <typename Fn>
+    void forEachOverlapping(int from, int to, Fn fn) const
+    {
+        auto it = reservations.lower_bound(from);
+        if (it != reservations.begin() && prev(it)->second.end > from)
+        {
+            --it;
+        }
+        for (; it != reservations.end() && it->first < to; ++it)
+        {
+            fn(it->first, it->second.end);
+        }
+    }
+
+    // Drops reservations over by 'day'. Ranges are disjoint, so they end in start order.
+    void pruneBefore(int day)
+    {
+        auto it = reservations.begin();
+        while (it != reservations.end() && it->second.end <= day)
+        {
+            it = reservations.erase(it);
+        }
+    }
+
+    // Returns the end day of the released range, or 'start' if nothing matched
+    int release(int start, int bookingId)
+    {
+        auto it = reservations.find(start);
+        if (it == reservations.end() || it->second.bookingId != bookingId)
+        {
+            return start;
+        }
+        int end = it->second.end;
+        reservations.erase(it);
+        return end;
+    }
+};
+
+// One car's schedule behind its own small lock, so bookings for different cars never wait
+// on each other and a claim is a single O(log n) check-and-insert in place. The lock is
+// only held for that one lookup or update, and never while taking another lock.
+class ScheduleCell
+{
+private:
+    mutable mutex lock;
+    CarSchedule schedule;
+
+public:
+    bool isFree(int start, int end) const
+    {
+        lock_guard<mutex> guard(lock);
+        return schedule.isFree(start, end);
+    }
+
+    template <typename Fn>
+    void forEachOverlapping(int from, int to, Fn fn) const
+    {
+        lock_guard<mutex> guard(lock);
+        schedule.forEachOverlapping(from, to, fn);
+    }
+
+    // Of overlapping claims exactly one wins: the check and the insert happen under the lock
+    bool claim(int start, int end, int bookingId)
+    {
+        lock_guard<mutex> guard(lock);
+        if (!schedule.isFree(start, end))
+        {
+            return false;
+        }
+        schedule.reserve(start, end, bookingId);
+        return true;
+    }
+
+    // Returns the end day of the released range, or 'start' if nothing matched
+    int release(int start, int bookingId)
+    {
+        lock_guard<mutex> guard(lock);
+        return schedule.release(start, bookingId);
+    }
+
+    void pruneBefore(int day)
+    {
+        lock_guard<mutex> guard(lock);
+        schedule.pruneBefore(day);
+    }
+};
+
+inline unsigned lowestSetBit(uint64_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+}
+
+// One bit per car per day across the whole fleet. A window query ORs together the busy
+// words of each day in the window and masks them out of the in-service set; the loops
+// are plain word-wise operations so the compiler can vectorize them. Only a rolling
+// window of days from today is kept, so memory is bounded by fleet size x horizonDays;
+// windows outside it are answered from the per-car schedules instead.
+class FleetAvailability
+{
+public:
+    static constexpr int horizonDays = 400;
+
+private:
+    vector<int> carAtBit;             // bit -> car id (0 when the bit is unused)
+    vector<size_t> freeBits;          // bits released by removed cars
+    unordered_map<int, size_t> bitOf; // car id -> bit
+    vector<uint64_t> inService;
+    unordered_map<int, vector<uint64_t>> busyByDay; // day -> busy bits (only days with bookings)
+    int firstDay = 0;                               // days kept: [firstDay, lastDay)
+    int lastDay = 0;
+
+    size_t wordCount() const { return (carAtBit.size() + 63) / 64; }
+
+    static void assign(vector<uint64_t> &words, size_t bit, bool value)
+    {
+        if (words.size() <= bit / 64)
+        {
+            words.resize(bit / 64 + 1, 0);
+        }
+        uint64_t mask = uint64_t(1) << (bit % 64);
+        words[bit / 64] = value ? (words[bit / 64] | mask) : (words[bit / 64] & ~mask);
+    }
+
+public:
+    void addCar(int carId, bool available)
+    {
+        size_t bit;
+        if (!freeBits.empty())
+        {
+            bit = freeBits.back();
+            freeBits.pop_back();
+        }
+        else
+        {
+            bit = carAtBit.size();
+            carAtBit.push_back(0);
+        }
+        carAtBit[bit] = carId;
+        bitOf[carId] = bit;
+        assign(inService, bit, available);
+    }
+
+    void removeCar(int carId)
+    {
+        auto it = bitOf.find(carId);
+        if (it == bitOf.end())
+        {
+            return;
+        }
+        size_t bit = it->second;
+        assign(inService, bit, false);
+        for (auto &[day, busy] : busyByDay)
+        {
+            if (bit / 64 < busy.size())
+            {
+                assign(busy, bit, false);
+            }
+        }
+        carAtBit[bit] = 0;
+        freeBits.push_back(bit);
+        bitOf.erase(it);
+    }
+
+    void setInService(int carId, bool available)
+    {
+        auto it = bitOf.find(carId);
+        if (it != bitOf.end())
+        {
+            assign(inService, it->second, available);
+        }
+    }
+
+    int horizonStart() const { return firstDay; }
+
+    // True if every day of [start, end) is tracked, so freeCars can answer the window
+    bool covers(int start, int end) const
+    {
+        return start >= firstDay && end <= lastDay;
+    }
+
+    // Move the window to start at 'today', dropping past days. Returns the range of days
+    // that just came into view; their bookings must be marked again by the caller.
+    pair<int, int> rollTo(int today)
+    {
+        for (auto it = busyByDay.begin(); it != busyByDay.end();)
+        {
+            it = it->first < today ? busyByDay.erase(it) : next(it);
+        }
+        int from = max(lastDay, today);
+        firstDay = today;
+        lastDay = today + horizonDays;
+        return {from, lastDay};
+    }
+
+    // Mark or clear the car as booked for every tracked day in [start, end)
+    void setBusy(int carId, int start, int end, bool busy)
+    {
+        auto it = bitOf.find(carId);
+        if (it == bitOf.end())
+        {
+            return;
+        }
+        for (int day = max(start, firstDay); day < min(end, lastDay); ++day)
+        {
+            if (busy)
+            {
+                assign(busyByDay[day], it->second, true);
+                continue;
+            }
+            auto words = busyByDay.find(day);
+            if (words == busyByDay.end())
+            {
+                continue;
+            }
+            assign(words->second, it->second, false);
+            if (all_of(words->second.begin(), words->second.end(), [](uint64_t word)
+                       { return word == 0; }))
+            {
+                busyByDay.erase(words);
+            }
+        }
+    }
+
+    // Ids of in-service cars with no booking on any day in [start, end); needs covers()
+    vector<int> freeCars(int start, int end) const
+    {
+        vector<uint64_t> free(inService);
+        free.resize(wordCount(), 0);
+        for (int day = start; day < end; ++day)
+        {
+            auto busy = busyByDay.find(day);
+            if (busy == busyByDay.end())
+            {
+                continue;
+            }
+            const uint64_t *words = busy->second.data();
+            size_t n = min(free.size(), busy->second.size());
+            for (size_t w = 0; w < n; ++w)
+            {
+                free[w] &= ~words[w];
+            }
+        }
+
+        vector<int> carIds;
+        for (size_t w = 0; w < free.size(); ++w)
+        {
+            for (uint64_t word = free[w]; word; word &= word - 1)
+            {
+                carIds.push_back(carAtBit[w * 64 + lowestSetBit(word)]);
+            }
+        }
+        return carIds;
+    }
+};
+
+// Strategy Pattern: Payment Strategy
+class PaymentStrategy
+{
+public:
+    virtual ~PaymentStrategy() = default;
+    virtual void pay(double amount) = 0;
+    virtual string getType() const = 0;
+};
+
+class CreditCardStrategy : public PaymentStrategy
+{
+public:
+    void pay(double amount) override
+    {
+        cout << "Paid " << fixed << setprecision(2) << amount << " via Credit Card\n";
+    }
+    string getType() const override { return "Credit Card"; }
+};
+
+class PayPalStrategy : public PaymentStrategy
+{
+public:
+    void pay(double amount) override
+    {
+        cout << "Paid " << fixed << setprecision(2) << amount << " via PayPal\n";
+    }
+    string getType() const override { return "PayPal"; }
+};
+
+class CashStrategy : public PaymentStrategy
+{
+public:
+    void pay(double amount) override
+    {
+        cout << "Paid " << fixed << setprecision(2) << amount << " in Cash\n";
+    }
+    string getType() const override { return "Cash"; }
+};
+
+// Interned string for low-cardinality values (brands, types, statuses, ...). Every
+// distinct text is stored once, so a symbol is one pointer and comparing two is a pointer
+// compare. Set nodes never move, which keeps the pointers valid as the table grows.
+class Symbol
+{
+private:
+    const string *text;
+
+    static const string *intern(const string &value)
+    {
+        static mutex tableMutex;
+        static unordered_set<string> table;
+        lock_guard<mutex> lock(tableMutex);
+        return &*table.insert(value).first;
+    }
+
+public:
+    Symbol(const string &value = string()) : text(intern(value)) {}
+    Symbol(const char *value) : text(intern(value)) {}
+
+    const string &str() const { return *text; }
+    bool operator==(const Symbol &other) const { return text == other.text; }
+    bool operator!=(const Symbol &other) const { return text != other.text; }
+
+    // Equal symbols share their text, so the address is a complete hash key
+    struct Hash
+    {
+        size_t operator()(const Symbol &symbol) const { return hash<const string *>()(symbol.text); }
+    };
+};
+
+ostream &operator<<(ostream &out, const Symbol &symbol)
+{
+    return out << symbol.str();
+}
+
+// Admin-controlled service state; date bookings are tracked separately per car
+enum class CarStatus : uint8_t
+{
+    Available,
+    Rented,
+    Maintenance
+};
+
+const string &statusName(CarStatus status)
+{
+    static const string names[] = {"Available", "Rented", "Maintenance"};
+    return names[static_cast<size_t>(status)];
+}
+
+bool parseCarStatus(string_view text, CarStatus &status)
+{
+    for (CarStatus candidate : {CarStatus::Available, CarStatus::Rented, CarStatus::Maintenance})
+    {
+        if (text == statusName(candidate))
+        {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+ostream &operator<<(ostream &out, CarStatus status)
+{
+    return out << statusName(status);
+}
+
+// Allowed moves as a bitmask of target states per current state, so a check is a shift
+// and a mask. Setting a car to the state it is already in is allowed.
+constexpr uint8_t stateBit(CarStatus status) { return uint8_t(1) << static_cast<unsigned>(status); }
+
+constexpr bool canTransition(CarStatus from, CarStatus to)
+{
+    constexpr uint8_t allowed[] = {
+        /* Available   */ stateBit(CarStatus::Available) | stateBit(CarStatus::Rented) | stateBit(CarStatus::Maintenance),
+        /* Rented      */ stateBit(CarStatus::Rented) | stateBit(CarStatus::Available) | stateBit(CarStatus::Maintenance),
+        /* Maintenance */ stateBit(CarStatus::Maintenance) | stateBit(CarStatus::Available),
+    };
+    return allowed[static_cast<size_t>(from)] & stateBit(to);
+}
+
+// Car class
+class Car
+{
+private:
+    int id;
+    Symbol brand;
+    Symbol model;
+    Symbol type;
+    int year;
+    Symbol color;
+    double pricePerDay;
+    string registrationNumber;
+    CarStatus status;
+
+public:
+    Car(int id, const string &brand, const string &model, const string &type,
+        int year, const string &color, double pricePerDay, const string &regNum,
+        CarStatus status = CarStatus::Available)
+        : id(id), brand(brand), model(model), type(type), year(year),
+          color(color), pricePerDay(pricePerDay), registrationNumber(regNum), status(status) {}
+
+    // Getters
+    int getId() const { return id; }
+    const string &getBrand() const { return brand.str(); }
+    const string &getModel() const { return model.str(); }
+    const string &getType() const { return type.str(); }
+    int getYear() const { return year; }
+    const string &getColor() const { return color.str(); }
+    double getPricePerDay() const { return pricePerDay; }
+    bool isAvailable() const { return status == CarStatus::Available; }
+    const string &getRegistrationNumber() const { return registrationNumber; }
+    CarStatus getStatus() const { return status; }
+
+    // Setters
+    void setPricePerDay(double price) { pricePerDay = price; }
+    void setStatus(CarStatus newStatus)
+    {
+        if (!canTransition(status, newStatus))
+        {
+            throw InvalidTransitionException(statusName(status), statusName(newStatus));
+        }
+        status = newStatus;
+    }
+    // Reapply a state read back from disk; it was validated when first set
+    void restoreStatus(CarStatus savedStatus) { status = savedStatus; }
+
+    void display() const
+    {
+        cout << "ID: " << id << " | " << year << " " << brand << " " << model
+             << " (" << color << ")\n"
+             << "Type: " << type << " | Reg: " << registrationNumber
+             << " | Price/Day: $" << fixed << setprecision(2) << pricePerDay
+             << " | Status: " << status << endl;
+    }
+
+    string serialize() const
+    {
+        return to_string(id) + "," + brand.str() + "," + model.str() + "," + type.str() + "," +
+               to_string(year) + "," + color.str() + "," + to_string(pricePerDay) + "," +
+               registrationNumber + "," + statusName(status);
+    }
+};
+
+// A combined car search. Empty strings and default bounds mean "any"; the date window is
+// [startDay, endDay) in day numbers and is ignored unless endDay > startDay.
+struct CarQuery
+{
+    enum class SortBy
+    {
+        Id,
+        Price, // cheapest first
+        Year   // newest first
+    };
+
+    string brand;   // substring, case-insensitive
+    string keyword; // substring of the brand, model or registration number
+    string type;
+    string color;
+    double minPrice = 0;
+    double maxPrice = numeric_limits<double>::max();
+    int minYear = numeric_limits<int>::min();
+    int maxYear = numeric_limits<int>::max();
+    int startDay = 0;
+    int endDay = 0;
+    SortBy sortBy = SortBy::Id;
+    size_t offset = 0;
+    size_t limit = 0; // 0 = no limit
+    bool fuzzy = false; // brand and keyword also accept values a few typos away
+
+    bool hasWindow() const { return endDay > startDay; }
+
+    // Any criterion besides the date window
+    bool hasFilters() const
+    {
+        return !brand.empty() || !keyword.empty() || !type.empty() || !color.empty() || minPrice > 0 ||
+               maxPrice != numeric_limits<double>::max() || minYear != numeric_limits<int>::min() ||
+               maxYear != numeric_limits<int>::max();
+    }
+};
+
+// One page of search results plus the number of matches across all pages. The cars are
+// copies, so a page stays valid after the tables change.
+struct CarPage
+{
+    vector<Car> cars;
+    size_t total = 0;
+};
+
+// Trigram index over the distinct values of one text field (brand, model, registration).
+// Each lowercase value is a term with a sorted list of the cars carrying it, and each
+// trigram of a term's padded text lists the terms containing it. A substring query
+// intersects the lists of its trigrams and verifies the survivors. A fuzzy query counts
+// shared trigrams per term: a term within k edits keeps all but at most 3k of the query's
+// distinct trigrams, so only terms over that bar reach the edit-distance check.
+class TermIndex
+{
+private:
+    vector<string> terms;       // term id -> lowercase text (empty once freed)
+    vector<vector<int>> carsOf; // term id -> sorted car ids
+    vector<int> freeIds;        // ids of terms whose last car went, reused by add
+    unordered_map<string, int> termIds;
+    unordered_map<uint32_t, vector<int>> termsWithGram; // trigram -> ascending term ids
+    size_t editCap;                                     // most typos a fuzzy match may have
+
+    // Fuzzy search scans a trigram's term list unless it is this many times longer than the
+    // candidates gathered so far, in which case binary-searching it per candidate is cheaper
+    static constexpr size_t probeRatio = 8;
+
+    // Levenshtein distance from one needle, computed bit-parallel (Hyyro's algorithm): one
+    // column of the DP table per word operation, so a check costs a few instructions per
+    // character. Needles over 64 bytes fall back to withinEdits.
+    class NeedleDistance
+    {
+    private:
+        const string &needle;
+        array<uint64_t, 256> positions{}; // byte -> bitmask of its positions in the needle
+
+    public:
+        explicit NeedleDistance(const string &needle) : needle(needle)
+        {
+            for (size_t i = 0; i < needle.size() && i < 64; ++i)
+            {
+                positions[uint8_t(needle[i])] |= uint64_t(1) << i;
+            }
+        }
+
+        bool within(const string &text, size_t maxEdits) const
+        {
+            size_t length = needle.size();
+            if (length == 0 || length > 64)
+            {
+                return withinEdits(needle, text, maxEdits);
+            }
+            if ((length > text.size() ? length - text.size() : text.size() - length) > maxEdits)
+            {
+                return false;
+            }
+            uint64_t last = uint64_t(1) << (length - 1);
+            uint64_t plus = length == 64 ? ~uint64_t(0) : (last << 1) - 1; // vertical +1 deltas
+            uint64_t minus = 0;                                           // vertical -1 deltas
+            size_t score = length;
+            for (char c : text)
+            {
+                uint64_t equal = positions[uint8_t(c)];
+                uint64_t vertical = equal | minus;
+                uint64_t horizontal = (((equal & plus) + plus) ^ plus) | equal;
+                uint64_t horizontalPlus = minus | ~(horizontal | plus);
+                uint64_t horizontalMinus = plus & horizontal;
+                score += (horizontalPlus & last) ? 1 : 0;
+                score -= (horizontalMinus & last) ? 1 : 0;
+                horizontalPlus = (horizontalPlus << 1) | 1;
+                horizontalMinus <<= 1;
+                plus = horizontalMinus | ~(vertical | horizontalPlus);
+                minus = horizontalPlus & vertical;
+            }
+            return score <= maxEdits;
+        }
+    };
+
+    // Distinct trigrams; padding lets the first and last letters of short terms count
+    static vector<uint32_t> gramsOf(const string &text, bool padded)
+    {
+        string source = padded ? "\1\1" + text + "\2\2" : text;
+        vector<uint32_t> grams;
+        for (size_t pos = 0; pos + 3 <= source.size(); ++pos)
+        {
+            grams.push_back(uint32_t(uint8_t(source[pos])) << 16 | uint32_t(uint8_t(source[pos + 1])) << 8 |
+                            uint8_t(source[pos + 2]));
+        }
+        sort(grams.begin(), grams.end());
+        grams.erase(unique(grams.begin(), grams.end()), grams.end());
+        return grams;
+    }
+
+    void containing(const string &needle, vector<int> &matches) const
+    {
+        if (needle.size() < 3)
+        {
+            // Too short to have a trigram: check the (deduplicated) vocabulary directly
+            for (size_t term = 0; term < terms.size(); ++term)
+            {
+                if (terms[term].find(needle) != string::npos)
+                {
+                    matches.push_back(static_cast<int>(term));
+                }
+            }
+            return;
+        }
+        vector<const vector<int> *> lists;
+        for (uint32_t gram : gramsOf(needle, false))
+        {
+            auto it = termsWithGram.find(gram);
+            if (it == termsWithGram.end())
+            {
+                return;
+            }
+            lists.push_back(&it->second);
+        }
+        sort(lists.begin(), lists.end(), [](const vector<int> *a, const vector<int> *b)
+             { return a->size() < b->size(); });
+        vector<int> candidates(*lists[0]);
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i)
+        {
+            vector<int> both;
+            set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(),
+                             back_inserter(both));
+            candidates.swap(both);
+        }
+        for (int term : candidates)
+        {
+            if (terms[term].find(needle) != string::npos)
+            {
+                matches.push_back(term);
+            }
+        }
+    }
+
+    void similar(const string &needle, vector<int> &matches) const
+    {
+        size_t maxEdits = allowedEdits(needle.size(), editCap);
+        if (maxEdits == 0)
+        {
+            return;
+        }
+
+        // An edit disturbs at most 3 of the padded needle's trigram positions, so a term within
+        // maxEdits shares at least 'needed' of them. Positions are counted with repeats, since
+        // a needle like "aaaaaa" has fewer distinct trigrams than 3 * maxEdits; each distinct
+        // trigram is weighted by how often it occurs. allowedEdits keeps 'needed' positive.
+        struct GramList
+        {
+            const vector<int> *terms;
+            size_t weight;
+        };
+        static const vector<int> none;
+        string padded = "\1\1" + needle + "\2\2";
+        vector<uint32_t> grams;
+        for (size_t pos = 0; pos + 3 <= padded.size(); ++pos)
+        {
+            grams.push_back(uint32_t(uint8_t(padded[pos])) << 16 | uint32_t(uint8_t(padded[pos + 1])) << 8 |
+                            uint8_t(padded[pos + 2]));
+        }
+        sort(grams.begin(), grams.end());
+        vector<GramList> lists;
+        for (size_t first = 0, last; first < grams.size(); first = last)
+        {
+            last = first;
+            while (last < grams.size() && grams[last] == grams[first])
+            {
+                ++last;
+            }
+            auto it = termsWithGram.find(grams[first]);
+            lists.push_back({it == termsWithGram.end() ? &none : &it->second, last - first});
+        }
+        size_t needed = grams.size() - 3 * maxEdits;
+
+        // A term reaching 'needed' must be in one of the rarest lists, chosen so that the rest
+        // weigh less than 'needed' together. Those are scanned into per-term counters, and so
+        // is any other list no more than probeRatio times the terms they yielded; the rest
+        // (huge lists such as "first letter is a") are probed per candidate instead.
+        sort(lists.begin(), lists.end(), [](const GramList &a, const GramList &b)
+             { return a.terms->size() < b.terms->size(); });
+        size_t required = 0;
+        for (size_t unscanned = grams.size(); unscanned >= needed; ++required)
+        {
+            unscanned -= lists[required].weight;
+        }
+
+        // Per-thread scratch, left zeroed: concurrent searches share the index, not this.
+        // Counters saturate, which only weakens the filter; candidates are verified anyway.
+        thread_local vector<uint8_t> weightOf;
+        thread_local vector<int> touched;
+        if (weightOf.size() < terms.size())
+        {
+            weightOf.resize(terms.size(), 0);
+        }
+        size_t scanned = 0;
+        size_t scanLimit = 0;
+        for (; scanned < lists.size(); ++scanned)
+        {
+            const GramList &list = lists[scanned];
+            if (scanned == required)
+            {
+                scanLimit = touched.size() * probeRatio;
+            }
+            if (scanned >= required && list.terms->size() > scanLimit)
+            {
+                break;
+            }
+            for (int term : *list.terms)
+            {
+                if (weightOf[term] == 0)
+                {
+                    touched.push_back(term);
+                }
+                weightOf[term] = static_cast<uint8_t>(min<size_t>(255, weightOf[term] + list.weight));
+            }
+        }
+
+        size_t probedWeight = 0;
+        for (size_t i = scanned; i < lists.size(); ++i)
+        {
+            probedWeight += lists[i].weight;
+        }
+        NeedleDistance distance(needle);
+        for (int term : touched)
+        {
+            size_t total = weightOf[term];
+            weightOf[term] = 0;
+            if (total + probedWeight < needed)
+            {
+                continue;
+            }
+            for (size_t i = scanned; i < lists.size() && total < needed; ++i)
+            {
+                if (binary_search(lists[i].terms->begin(), lists[i].terms->end(), term))
+                {
+                    total += lists[i].weight;
+                }
+            }
+            if (total >= min<size_t>(needed, 255) && distance.within(terms[term], maxEdits))
+            {
+                matches.push_back(term);
+            }
+        }
+        touched.clear();
+    }
+
+public:
+    explicit TermIndex(size_t editCap = 2) : editCap(editCap) {}
+
+    // Typos tolerated for a query of this length: none below 3 letters, then 1, then 2
+    static size_t allowedEdits(size_t length, size_t cap = 2)
+    {
+        return min(cap, length < 3 ? size_t(0) : length < 6 ? size_t(1) : size_t(2));
+    }
+
+    // Levenshtein distance <= maxEdits, abandoning a row once every cell exceeds it
+    static bool withinEdits(const string &a, const string &b, size_t maxEdits)
+    {
+        if ((a.size() > b.size() ? a.size() - b.size() : b.size() - a.size()) > maxEdits)
+        {
+            return false;
+        }
+        vector<size_t> row(b.size() + 1);
+        for (size_t j = 0; j <= b.size(); ++j)
+        {
+            row[j] = j;
+        }
+        for (size_t i = 1; i <= a.size(); ++i)
+        {
+            size_t diagonal = row[0];
+            row[0] = i;
+            size_t best = row[0];
+            for (size_t j = 1; j <= b.size(); ++j)
+            {
+                size_t above = row[j];
+                row[j] = min({above + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1])});
+                diagonal = above;
+                best = min(best, row[j]);
+            }
+            if (best > maxEdits)
+            {
+                return false;
+            }
+        }
+        return row[b.size()] <= maxEdits;
+    }
+
+    // 'text' is the already-lowercased field value
+    void add(int carId, const string &text)
+    {
+        auto [it, inserted] = termIds.emplace(text, 0);
+        if (inserted)
+        {
+            if (freeIds.empty())
+            {
+                it->second = static_cast<int>(terms.size());
+                terms.push_back(text);
+                carsOf.emplace_back();
+            }
+            else
+            {
+                it->second = freeIds.back();
+                freeIds.pop_back();
+                terms[it->second] = text;
+            }
+            for (uint32_t gram : gramsOf(text, true))
+            {
+                vector<int> &termIdsOfGram = termsWithGram[gram];
+                termIdsOfGram.insert(lower_bound(termIdsOfGram.begin(), termIdsOfGram.end(), it->second), it->second);
+            }
+        }
+        vector<int> &ids = carsOf[it->second];
+        ids.insert(lower_bound(ids.begin(), ids.end(), carId), carId);
+    }
+
+    void remove(int carId, const string &text)
+    {
+        auto it = termIds.find(text);
+        if (it == termIds.end())
+        {
+            return;
+        }
+        int term = it->second;
+        vector<int> &ids = carsOf[term];
+        auto pos = lower_bound(ids.begin(), ids.end(), carId);
+        if (pos != ids.end() && *pos == carId)
+        {
+            ids.erase(pos);
+        }
+        if (!ids.empty())
+        {
+            return;
+        }
+
+        // Last car gone: drop the term from the vocabulary and its trigram lists, so
+        // searches stop verifying it, and recycle its id
+        for (uint32_t gram : gramsOf(terms[term], true))
+        {
+            auto gramIt = termsWithGram.find(gram);
+            vector<int> &termIdsOfGram = gramIt->second;
+            termIdsOfGram.erase(lower_bound(termIdsOfGram.begin(), termIdsOfGram.end(), term));
+            if (termIdsOfGram.empty())
+            {
+                termsWithGram.erase(gramIt);
+            }
+        }
+        termIds.erase(it);
+        terms[term].clear();
+        terms[term].shrink_to_fit();
+        ids.shrink_to_fit();
+        freeIds.push_back(term);
+    }
+
+    // Distinct terms currently carried by at least one car
+    size_t termCount() const { return termIds.size(); }
+
+    // Calls fn(carIds) once per term containing the needle (or, if fuzzy, close to it)
+    template <typename Fn>
+    void forMatches(const string &needle, bool fuzzy, Fn fn) const
+    {
+        vector<int> matches;
+        containing(needle, matches);
+        if (fuzzy)
+        {
+            similar(needle, matches);
+            sort(matches.begin(), matches.end());
+            matches.erase(unique(matches.begin(), matches.end()), matches.end());
+        }
+        for (int term : matches)
+        {
+            if (!carsOf[term].empty())
+            {
+                fn(carsOf[term]);
+            }
+        }
+    }
+};
+
+// Lowercase 'key' contains the lowercase needle, or (if fuzzy) is a typo or two away from it
+bool textMatches(const string &key, const string &needle, bool fuzzy, size_t editCap = 2)
+{
+    return key.find(needle) != string::npos ||
+           (fuzzy && TermIndex::withinEdits(needle, key, TermIndex::allowedEdits(needle.size(), editCap)));
+}
+
+// Inverted indexes behind the car search filters. Text fields are lowercased once on
+// insert. Brand, model and registration go into trigram indexes; type and color map to
+// sorted posting lists of car ids, so a "contains" query only scans their distinct keys
+// (a handful). Years and prices map to posting lists too, ordered by value, so a range
+// query visits only the distinct values inside it.
+class CarSearchIndex
+{
+private:
+    // Lowercase text keys. The low-cardinality ones are interned; model and registration
+    // are close to one per car, so interning them would only grow the global Symbol table.
+    struct Keys
+    {
+        Symbol brand;
+        string model;
+        string registration;
+        Symbol type;
+        Symbol color;
+        int year;
+        double price;
+    };
+    using Postings = map<string, vector<int>>; // lowercase key -> sorted car ids
+
+    unordered_map<int, Keys> keysOf; // car id -> precomputed keys
+    // Plates are codes, not words: one wrong character is a typo, two is another car. It
+    // also keeps fuzzy lookups fast across a million distinct plates.
+    static constexpr size_t registrationEdits = 1;
+
+    TermIndex brands;
+    TermIndex models;
+    TermIndex registrations{registrationEdits};
+    Postings byType;
+    Postings byColor;
+    map<int, vector<int>> byYear;
+    map<double, vector<int>> byPrice;
+
+    // One indexed criterion of a query, with the number of ids its lists would yield
+    enum class Term
+    {
+        Brand,
+        Keyword,
+        Type,
+        Color,
+        Year,
+        Price
+    };
+    struct Step
+    {
+        Term term;
+        size_t estimate;
+    };
+
+    // Query strings lowercased once per search
+    struct Needles
+    {
+        string brand;
+        string keyword;
+        string type;
+        string color;
+    };
+
+    // Listing only intersects a posting list this many times larger than the running
+    // result; beyond that it is cheaper to test each survivor's keys directly.
+    static constexpr size_t intersectRatio = 8;
+
+    template <typename Key>
+    static void addPosting(map<Key, vector<int>> &postings, const Key &key, int carId)
+    {
+        vector<int> &ids = postings[key];
+        ids.insert(lower_bound(ids.begin(), ids.end(), carId), carId);
+    }
+
+    template <typename Key>
+    static void removePosting(map<Key, vector<int>> &postings, const Key &key, int carId)
+    {
+        auto it = postings.find(key);
+        if (it == postings.end())
+        {
+            return;
+        }
+        vector<int> &ids = it->second;
+        auto pos = lower_bound(ids.begin(), ids.end(), carId);
+        if (pos != ids.end() && *pos == carId)
+        {
+            ids.erase(pos);
+        }
+        if (ids.empty())
+        {
+            postings.erase(it);
+        }
+    }
+
+    // Calls fn(ids) for every posting list whose key contains the needle
+    template <typename Fn>
+    static void forMatchingKeys(const Postings &postings, const string &needle, Fn fn)
+    {
+        for (const auto &[key, ids] : postings)
+        {
+            if (key.find(needle) != string::npos)
+            {
+                fn(ids);
+            }
+        }
+    }
+
+    // Calls fn(ids) for every posting list whose key lies in [low, high]
+    template <typename Key, typename Fn>
+    static void forKeysBetween(const map<Key, vector<int>> &postings, Key low, Key high, Fn fn)
+    {
+        for (auto it = postings.lower_bound(low); it != postings.end() && it->first <= high; ++it)
+        {
+            fn(it->second);
+        }
+    }
+
+    size_t estimate(Term term, const CarQuery &query, const Needles &needles) const
+    {
+        size_t count = 0;
+        auto add = [&count](const vector<int> &ids)
+        { count += ids.size(); };
+        switch (term)
+        {
+        case Term::Brand:
+            brands.forMatches(needles.brand, query.fuzzy, add);
+            break;
+        case Term::Keyword:
+            brands.forMatches(needles.keyword, query.fuzzy, add);
+            models.forMatches(needles.keyword, query.fuzzy, add);
+            registrations.forMatches(needles.keyword, query.fuzzy, add);
+            break;
+        case Term::Type:
+            forMatchingKeys(byType, needles.type, add);
+            break;
+        case Term::Color:
+            forMatchingKeys(byColor, needles.color, add);
+            break;
+        case Term::Year:
+            forKeysBetween(byYear, query.minYear, query.maxYear, add);
+            break;
+        case Term::Price:
+            forKeysBetween(byPrice, query.minPrice, query.maxPrice, add);
+            break;
+        }
+        return count;
+    }
+
+    // Materialize the sorted ids for one criterion
+    vector<int> fetch(Term term, const CarQuery &query, const Needles &needles) const
+    {
+        vector<int> carIds;
+        auto merge = [&carIds](const vector<int> &ids)
+        {
+            size_t middle = carIds.size();
+            carIds.insert(carIds.end(), ids.begin(), ids.end());
+            inplace_merge(carIds.begin(), carIds.begin() + middle, carIds.end());
+        };
+        // Ranges can span many lists: gather them and sort once instead of merging each
+        auto append = [&carIds](const vector<int> &ids)
+        { carIds.insert(carIds.end(), ids.begin(), ids.end()); };
+        switch (term)
+        {
+        case Term::Brand:
+            brands.forMatches(needles.brand, query.fuzzy, merge);
+            break;
+        case Term::Keyword:
+            // A car can match in more than one field
+            brands.forMatches(needles.keyword, query.fuzzy, merge);
+            models.forMatches(needles.keyword, query.fuzzy, merge);
+            registrations.forMatches(needles.keyword, query.fuzzy, merge);
+            carIds.erase(unique(carIds.begin(), carIds.end()), carIds.end());
+            break;
+        case Term::Type:
+            forMatchingKeys(byType, needles.type, merge);
+            break;
+        case Term::Color:
+            forMatchingKeys(byColor, needles.color, merge);
+            break;
+        case Term::Year:
+            forKeysBetween(byYear, query.minYear, query.maxYear, append);
+            sort(carIds.begin(), carIds.end());
+            break;
+        case Term::Price:
+            forKeysBetween(byPrice, query.minPrice, query.maxPrice, append);
+            sort(carIds.begin(), carIds.end());
+            break;
+        }
+        return carIds;
+    }
+
+    static bool matches(const Keys &keys, Term term, const CarQuery &query, const Needles &needles)
+    {
+        switch (term)
+        {
+        case Term::Brand:
+            return textMatches(keys.brand.str(), needles.brand, query.fuzzy);
+        case Term::Keyword:
+            return textMatches(keys.brand.str(), needles.keyword, query.fuzzy) ||
+                   textMatches(keys.model, needles.keyword, query.fuzzy) ||
+                   textMatches(keys.registration, needles.keyword, query.fuzzy, registrationEdits);
+        case Term::Type:
+            return keys.type.str().find(needles.type) != string::npos;
+        case Term::Color:
+            return keys.color.str().find(needles.color) != string::npos;
+        case Term::Year:
+            return keys.year >= query.minYear && keys.year <= query.maxYear;
+        case Term::Price:
+            return keys.price >= query.minPrice && keys.price <= query.maxPrice;
+        }
+        return false;
+    }
+
+public:
+    void add(const Car &car)
+    {
+        int carId = car.getId();
+        remove(carId);
+        Keys keys{toLowerCopy(car.getBrand()), toLowerCopy(car.getModel()), toLowerCopy(car.getRegistrationNumber()),
+                  toLowerCopy(car.getType()), toLowerCopy(car.getColor()), car.getYear(), car.getPricePerDay()};
+        brands.add(carId, keys.brand.str());
+        models.add(carId, keys.model);
+        registrations.add(carId, keys.registration);
+        addPosting(byType, keys.type.str(), carId);
+        addPosting(byColor, keys.color.str(), carId);
+        addPosting(byYear, keys.year, carId);
+        addPosting(byPrice, keys.price, carId);
+        keysOf.emplace(carId, move(keys));
+    }
+
+    void remove(int carId)
+    {
+        auto it = keysOf.find(carId);
+        if (it == keysOf.end())
+        {
+            return;
+        }
+        brands.remove(carId, it->second.brand.str());
+        models.remove(carId, it->second.model);
+        registrations.remove(carId, it->second.registration);
+        removePosting(byType, it->second.type.str(), carId);
+        removePosting(byColor, it->second.color.str(), carId);
+        removePosting(byYear, it->second.year, carId);
+        removePosting(byPrice, it->second.price, carId);
+        keysOf.erase(it);
+    }
+
+    void setPrice(int carId, double price)
+    {
+        auto it = keysOf.find(carId);
+        if (it == keysOf.end())
+        {
+            return;
+        }
+        removePosting(byPrice, it->second.price, carId);
+        it->second.price = price;
+        addPosting(byPrice, price, carId);
+    }
+
+    // Sorted ids matching every indexed criterion of the query. The criterion with the
+    // fewest ids drives; the rest are intersected while their lists are comparable in size
+    // and checked against each survivor's keys otherwise. False if the query has no indexed
+    // criterion, or if even the driver would yield more than 'scanAbove' ids and has no
+    // keyword (which only the index can answer), so a column scan is the cheaper plan.
+    bool candidates(const CarQuery &query, vector<int> &carIds, size_t scanAbove) const
+    {
+        Needles needles{toLowerCopy(query.brand), toLowerCopy(query.keyword), toLowerCopy(query.type),
+                        toLowerCopy(query.color)};
+        vector<Step> plan;
+        auto consider = [&](Term term)
+        { plan.push_back({term, estimate(term, query, needles)}); };
+        if (!query.brand.empty())
+        {
+            consider(Term::Brand);
+        }
+        if (!query.keyword.empty())
+        {
+            consider(Term::Keyword);
+        }
+        if (!query.type.empty())
+        {
+            consider(Term::Type);
+        }
+        if (!query.color.empty())
+        {
+            consider(Term::Color);
+        }
+        if (query.minYear != numeric_limits<int>::min() || query.maxYear != numeric_limits<int>::max())
+        {
+            consider(Term::Year);
+        }
+        if (query.minPrice > 0 || query.maxPrice != numeric_limits<double>::max())
+        {
+            consider(Term::Price);
+        }
+        if (plan.empty())
+        {
+            return false;
+        }
+        sort(plan.begin(), plan.end(), [](const Step &a, const Step &b)
+             { return a.estimate < b.estimate; });
+        if (query.keyword.empty() && plan[0].estimate > scanAbove)
+        {
+            return false;
+        }
+
+        carIds = fetch(plan[0].term, query, needles);
+        for (size_t i = 1; i < plan.size() && !carIds.empty(); ++i)
+        {
+            const Step &step = plan[i];
+            if (step.estimate <= carIds.size() * intersectRatio)
+            {
+                vector<int> other = fetch(step.term, query, needles);
+                vector<int> both;
+                set_intersection(carIds.begin(), carIds.end(), other.begin(), other.end(), back_inserter(both));
+                carIds.swap(both);
+            }
+            else
+            {
+                carIds.erase(remove_if(carIds.begin(), carIds.end(), [&](int carId)
+                                       { return !matches(keysOf.at(carId), step.term, query, needles); }),
+                             carIds.end());
+            }
+        }
+        return true;
+    }
+};
+
+// Column-wise copy of the fields that filter scans read, one row per fleet slot (same
+// order as CarRentalSystem::cars). Car stays the per-car facade for display and saving;
+// scans walk these contiguous arrays instead of chasing a pointer and six strings per car.
+class FleetColumns
+{
+private:
+    // A text column as small per-row codes into the column's distinct lowercase values, so
+    // a text filter is decided once per value rather than once per row
+    struct SymbolColumn
+    {
+        vector<Symbol> values; // code -> value, in first-seen order
+        unordered_map<Symbol, uint32_t, Symbol::Hash> codes;
+        vector<uint32_t> rows;
+
+        void append(const string &text)
+        {
+            Symbol value(toLowerCopy(text));
+            auto [it, inserted] = codes.emplace(value, static_cast<uint32_t>(values.size()));
+            if (inserted)
+            {
+                values.push_back(value);
+            }
+            rows.push_back(it->second);
+        }
+
+        // One flag per code: does its value satisfy the text criterion?
+        vector<uint8_t> matchTable(const string &needle, bool fuzzy) const
+        {
+            vector<uint8_t> table(values.size(), 1);
+            if (!needle.empty())
+            {
+                string lowered = toLowerCopy(needle);
+                for (uint32_t code = 0; code < values.size(); ++code)
+                {
+                    table[code] = textMatches(values[code].str(), lowered, fuzzy);
+                }
+            }
+            return table;
+        }
+    };
+
+    SymbolColumn brands;
+    SymbolColumn types;
+    SymbolColumn colors;
+    vector<int> ids;
+    vector<double> prices;
+    vector<int> years;
+    vector<uint8_t> inService;
+
+public:
+    void append(const Car &car)
+    {
+        ids.push_back(car.getId());
+        prices.push_back(car.getPricePerDay());
+        years.push_back(car.getYear());
+        inService.push_back(car.isAvailable());
+        brands.append(car.getBrand());
+        types.append(car.getType());
+        colors.append(car.getColor());
+    }
+
+    void erase(size_t slot)
+    {
+        ids.erase(ids.begin() + slot);
+        prices.erase(prices.begin() + slot);
+        years.erase(years.begin() + slot);
+        inService.erase(inService.begin() + slot);
+        brands.rows.erase(brands.rows.begin() + slot);
+        types.rows.erase(types.rows.begin() + slot);
+        colors.rows.erase(colors.rows.begin() + slot);
+    }
+
+    void setPrice(size_t slot, double price) { prices[slot] = price; }
+    void setInService(size_t slot, bool available) { inService[slot] = available; }
+    bool isInService(size_t slot) const { return inService[slot]; }
+    size_t size() const { return ids.size(); }
+
+    // Calls fn(slot) for each in-service car meeting the query's brand, type, color, price
+    // and year criteria. The numeric tests run branch-free over a block of each array so
+    // the compiler can vectorize them; text criteria are lookups in per-value tables.
+    template <typename Fn>
+    void scan(const CarQuery &query, Fn fn) const
+    {
+        vector<uint8_t> brandOk = brands.matchTable(query.brand, query.fuzzy);
+        vector<uint8_t> typeOk = types.matchTable(query.type, false);
+        vector<uint8_t> colorOk = colors.matchTable(query.color, false);
+
+        constexpr size_t block = 256;
+        uint8_t keep[block];
+        for (size_t first = 0; first < ids.size(); first += block)
+        {
+            size_t n = min(block, ids.size() - first);
+            const double *price = prices.data() + first;
+            const int *year = years.data() + first;
+            const uint8_t *service = inService.data() + first;
+            for (size_t i = 0; i < n; ++i)
+            {
+                keep[i] = service[i] & (price[i] >= query.minPrice) & (price[i] <= query.maxPrice) &
+                          (year[i] >= query.minYear) & (year[i] <= query.maxYear);
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t slot = first + i;
+                if (keep[i] && brandOk[brands.rows[slot]] && typeOk[types.rows[slot]] && colorOk[colors.rows[slot]])
+                {
+                    fn(slot);
+                }
+            }
+        }
+    }
+};
+
+enum class BookingStatus : uint8_t
+{
+    Pending,
+    Approved,
+    Rejected,
+    Paid,
+    Cancelled,
+    Returned
+};
+
+// Text form used in bookings.dat, the logs and the UI
+const string &statusName(BookingStatus status)
+{
+    static const string names[] = {"Pending", "Approved", "Rejected", "Paid", "Cancelled", "Returned"};
+    return names[static_cast<size_t>(status)];
+}
+
+bool parseBookingStatus(string_view text, BookingStatus &status)
+{
+    for (BookingStatus candidate : {BookingStatus::Pending, BookingStatus::Approved, BookingStatus::Rejected,
+                                    BookingStatus::Paid, BookingStatus::Cancelled, BookingStatus::Returned})
+    {
+        if (text == statusName(candidate))
+        {
+            status = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+ostream &operator<<(ostream &out, BookingStatus status)
+{
+    return out << statusName(status);
+}
+
+constexpr uint8_t stateBit(BookingStatus status) { return uint8_t(1) << static_cast<unsigned>(status); }
+
+// Pending -> Approved/Rejected/Cancelled, Approved -> Paid/Cancelled/Returned,
+// Paid -> Returned; Rejected, Cancelled and Returned are final
+constexpr bool canTransition(BookingStatus from, BookingStatus to)
+{
+    constexpr uint8_t allowed[] = {
+        /* Pending   */ stateBit(BookingStatus::Approved) | stateBit(BookingStatus::Rejected) | stateBit(BookingStatus::Cancelled),
+        /* Approved  */ stateBit(BookingStatus::Paid) | stateBit(BookingStatus::Cancelled) | stateBit(BookingStatus::Returned),
+        /* Rejected  */ 0,
+        /* Paid      */ stateBit(BookingStatus::Returned),
+        /* Cancelled */ 0,
+        /* Returned  */ 0,
+    };
+    return allowed[static_cast<size_t>(from)] & stateBit(to);
+}
+
+// Booking class
+class Booking
+{
+private:
+    int id;
+    int userId;
+    int carId;
+    Date startDate;
+    Date endDate; // exclusive: the car is free again on this day
+    BookingStatus status;
+    double totalPrice;
+    Date bookingDate;
+
+public:
+    Booking(int id, int userId, int carId, Date startDate, Date endDate, double totalPrice,
+            BookingStatus status = BookingStatus::Pending, Date bookingDate = Date::today())
+        : id(id), userId(userId), carId(carId), startDate(startDate),
+          endDate(endDate), totalPrice(totalPrice), status(status),
+          bookingDate(bookingDate) {}
+
+    // Unrecognised status text loads as Pending
+    // Dates stay text on disk so older bookings.dat files load unchanged. A booking whose
+    // dates cannot be read gets an empty range and does not block its car.
+    static Booking fromRecord(const BookingRecord &record)
+    {
+        BookingStatus status = BookingStatus::Pending;
+        parseBookingStatus(fieldString(record.status), status);
+        Date start, end, booked;
+        if (!Date::tryParse(fieldString(record.startDate), start) || !Date::tryParse(fieldString(record.endDate), end))
+        {
+            end = start;
+        }
+        Date::tryParse(fieldString(record.bookingDate), booked);
+        return Booking(record.id, record.userId, record.carId, start, end, record.totalPrice, status, booked);
+    }
+
+    // Getters
+    int getId() const { return id; }
+    int getUserId() const { return userId; }
+    int getCarId() const { return carId; }
+    Date getStartDate() const { return startDate; }
+    Date getEndDate() const { return endDate; }
+    BookingStatus getStatus() const { return status; }
+    double getTotalPrice() const { return totalPrice; }
+    Date getBookingDate() const { return bookingDate; }
+
+    // Setters
+    void setStatus(BookingStatus newStatus)
+    {
+        if (!canTransition(status, newStatus))
+        {
+            throw InvalidTransitionException(statusName(status), statusName(newStatus));
+        }
+        status = newStatus;
+    }
+
+    BookingRecord toRecord() const
+    {
+        BookingRecord record{};
+        record.id = id;
+        record.userId = userId;
+        record.carId = carId;
+        copyField(record.startDate, startDate.toString());
+        copyField(record.endDate, endDate.toString());
+        copyField(record.status, statusName(status));
+        copyField(record.bookingDate, bookingDate.toString());
+        record.totalPrice = totalPrice;
+        return record;
+    }
+
+    void display() const
+    {
+        cout << "Booking ID: " << id << "\n";
+        cout << "Status: " << status << "\n";
+        cout << "Dates: " << startDate << " to " << endDate << "\n";
+        cout << "Total Price: $" << fixed << setprecision(2) << totalPrice << "\n";
+        cout << "Booked on: " << bookingDate << "\n";
+    }
+};
+
+// Payment class
+class Payment
+{
+private:
+    int id;
+    int bookingId;
+    double amount;
+    string date;
+    Symbol status;
+    Symbol method;
+    string transactionId;
+
+public:
+    Payment(int id, int bookingId, double amount, const string &method,
+            const string &status = "Completed", const string &date = getCurrentDate(),
+            const string &transactionId = "") // defaults to the (unique) payment id
+        : id(id), bookingId(bookingId), amount(amount), method(method),
+          status(status), date(date), transactionId(transactionId.empty() ? to_string(id) : transactionId) {}
+
+    static Payment fromRecord(const PaymentRecord &record)
+    {
+        return Payment(record.id, record.bookingId, record.amount,
+                       fieldString(record.method), fieldString(record.status),
+                       fieldString(record.date), fieldString(record.transactionId));
+    }
+
+    PaymentRecord toRecord() const
+    {
+        PaymentRecord record{};
+        record.id = id;
+        record.bookingId = bookingId;
+        record.amount = amount;
+        copyField(record.date, date);
+        copyField(record.status, status.str());
+        copyField(record.method, method.str());
+        copyField(record.transactionId, transactionId);
+        return record;
+    }
+
+    // Getters
+    int getId() const { return id; }
+    int getBookingId() const { return bookingId; }
     double getAmount() const { return amount; }
     string getDate() const { return date; }
-    string getStatus() const { return status; }
-    string getMethod() const { return method; }
+    const string &getStatus() const { return status.str(); }
+    const string &getMethod() const { return method.str(); }
     string getTransactionId() const { return transactionId; }
 
-    void display() const
+    void display() const
+    {
+        cout << "Payment ID: " << id << " | Booking ID: " << bookingId
+             << " | Transaction: " << transactionId
+             << "\nAmount: $" << fixed << setprecision(2) << amount
+             << " | Date: " << date << " | Method: " << method
+             << "\nStatus: " << status << endl;
+    }
+};
+
+// Secondary indexes over the booking table, kept in step with every add and status
+// change. Lists hold booking ids in ascending order, which is booking order since ids
+// only grow, so a listing costs the size of its result rather than the whole history.
+class BookingIndex
+{
+private:
+    static constexpr size_t statusCount = static_cast<size_t>(BookingStatus::Returned) + 1;
+
+    array<vector<int>, statusCount> byStatus;
+    unordered_map<int, vector<int>> byCar;   // car id -> booking ids
+    unordered_map<int, vector<int>> byUser;  // user id -> booking ids
+    unordered_map<int, int> paymentOf;       // booking id -> payment id
+
+    static void insertId(vector<int> &ids, int bookingId)
+    {
+        // Usually the newest id, so this is an append
+        ids.insert(lower_bound(ids.begin(), ids.end(), bookingId), bookingId);
+    }
+
+    static void eraseId(vector<int> &ids, int bookingId)
+    {
+        auto pos = lower_bound(ids.begin(), ids.end(), bookingId);
+        if (pos != ids.end() && *pos == bookingId)
+        {
+            ids.erase(pos);
+        }
+    }
+
+    static const vector<int> &lookup(const unordered_map<int, vector<int>> &lists, int key)
+    {
+        static const vector<int> none;
+        auto it = lists.find(key);
+        return it != lists.end() ? it->second : none;
+    }
+
+public:
+    void add(const Booking &booking)
+    {
+        insertId(byStatus[static_cast<size_t>(booking.getStatus())], booking.getId());
+        insertId(byCar[booking.getCarId()], booking.getId());
+        insertId(byUser[booking.getUserId()], booking.getId());
+    }
+
+    void changeStatus(int bookingId, BookingStatus from, BookingStatus to)
+    {
+        if (from == to)
+        {
+            return;
+        }
+        eraseId(byStatus[static_cast<size_t>(from)], bookingId);
+        insertId(byStatus[static_cast<size_t>(to)], bookingId);
+    }
+
+    // A booking is paid once; should a legacy file hold more, the first one is reported
+    void addPayment(int bookingId, int paymentId)
+    {
+        paymentOf.emplace(bookingId, paymentId);
+    }
+
+    const vector<int> &withStatus(BookingStatus status) const
+    {
+        return byStatus[static_cast<size_t>(status)];
+    }
+
+    const vector<int> &ofCar(int carId) const { return lookup(byCar, carId); }
+    const vector<int> &ofUser(int userId) const { return lookup(byUser, userId); }
+
+    // Payment id for the booking, or -1 if it has not been paid
+    int paymentFor(int bookingId) const
+    {
+        auto it = paymentOf.find(bookingId);
+        return it != paymentOf.end() ? it->second : -1;
+    }
+};
+
+// Builds one flat JSON object per line (JSON Lines)
+class JsonWriter
+{
+private:
+    string out = "{";
+
+    void key(const char *name)
+    {
+        if (out.size() > 1)
+        {
+            out += ',';
+        }
+        out += '"';
+        out += name;
+        out += "\":";
+    }
+
+public:
+    JsonWriter &field(const char *name, const string &value)
+    {
+        key(name);
+        out += '"';
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+        return *this;
+    }
+
+    JsonWriter &field(const char *name, int value)
+    {
+        key(name);
+        out += to_string(value);
+        return *this;
+    }
+
+    JsonWriter &field(const char *name, int64_t value)
+    {
+        key(name);
+        out += to_string(value);
+        return *this;
+    }
+
+    JsonWriter &field(const char *name, double value)
+    {
+        key(name);
+        char text[32];
+        snprintf(text, sizeof(text), "%.2f", value);
+        out += text;
+        return *this;
+    }
+
+    string line() const
+    {
+        return out + "}\n";
+    }
+};
+
+// Walk the fields of a flat JSON object, passing each key and its (unescaped) value.
+// Returns false if the line is not a well-formed flat object.
+template <typename Visitor>
+bool forEachJsonField(string_view line, Visitor &&visit)
+{
+    size_t pos = line.find('{');
+    if (pos == string_view::npos)
+    {
+        return false;
+    }
+    pos++;
+
+    string value;
+    while (pos < line.size())
+    {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == ','))
+        {
+            pos++;
+        }
+        if (pos < line.size() && line[pos] == '}')
+        {
+            return true;
+        }
+        if (pos >= line.size() || line[pos] != '"')
+        {
+            return false;
+        }
+        size_t keyEnd = line.find('"', pos + 1);
+        if (keyEnd == string_view::npos || keyEnd + 1 >= line.size() || line[keyEnd + 1] != ':')
+        {
+            return false;
+        }
+        string_view key = line.substr(pos + 1, keyEnd - pos - 1);
+        pos = keyEnd + 2;
+
+        value.clear();
+        if (pos < line.size() && line[pos] == '"')
+        {
+            for (pos++; pos < line.size() && line[pos] != '"'; pos++)
+            {
+                if (line[pos] != '\\' || pos + 1 >= line.size())
+                {
+                    value += line[pos];
+                    continue;
+                }
+                char escaped = line[++pos];
+                if (escaped == 'n')
+                    value += '\n';
+                else if (escaped == 'r')
+                    value += '\r';
+                else if (escaped == 't')
+                    value += '\t';
+                else if (escaped == 'u' && pos + 4 < line.size())
+                {
+                    unsigned code = 0;
+                    from_chars(line.data() + pos + 1, line.data() + pos + 5, code, 16);
+                    value += static_cast<char>(code);
+                    pos += 4;
+                }
+                else
+                    value += escaped;
+            }
+            if (pos >= line.size())
+            {
+                return false;
+            }
+            pos++; // Closing quote
+        }
+        else
+        {
+            size_t end = line.find_first_of(",}", pos);
+            if (end == string_view::npos)
+            {
+                return false;
+            }
+            value.assign(line.substr(pos, end - pos));
+            pos = end;
+        }
+        visit(key, value);
+    }
+    return false;
+}
+
+// Typed log events; each renders the human-readable block the text logs used to hold
+struct TransactionEvent
+{
+    string timestamp;
+    string username;
+    string email;
+    int carId = 0;
+    string carName;
+    string carType;
+    string registration;
+    int bookingId = 0;
+    string startDate;
+    string endDate;
+    int days = 0;
+    int paymentId = 0;
+    double amount = 0.0;
+    string method;
+    string status;
+    string transactionId;
+
+    string toJson() const
+    {
+        return JsonWriter()
+            .field("type", string("transaction"))
+            .field("timestamp", timestamp)
+            .field("username", username)
+            .field("email", email)
+            .field("carId", carId)
+            .field("car", carName)
+            .field("carType", carType)
+            .field("registration", registration)
+            .field("bookingId", bookingId)
+            .field("startDate", startDate)
+            .field("endDate", endDate)
+            .field("days", days)
+            .field("paymentId", paymentId)
+            .field("amount", amount)
+            .field("method", method)
+            .field("status", status)
+            .field("transactionId", transactionId)
+            .line();
+    }
+
+    bool parse(string_view line)
+    {
+        bool matches = false;
+        bool valid = forEachJsonField(line, [this, &matches](string_view key, const string &value)
+                                      {
+                                          if (key == "type") matches = (value == "transaction");
+                                          else if (key == "timestamp") timestamp = value;
+                                          else if (key == "username") username = value;
+                                          else if (key == "email") email = value;
+                                          else if (key == "carId") parseNumber(value, carId);
+                                          else if (key == "car") carName = value;
+                                          else if (key == "carType") carType = value;
+                                          else if (key == "registration") registration = value;
+                                          else if (key == "bookingId") parseNumber(value, bookingId);
+                                          else if (key == "startDate") startDate = value;
+                                          else if (key == "endDate") endDate = value;
+                                          else if (key == "days") parseNumber(value, days);
+                                          else if (key == "paymentId") parseNumber(value, paymentId);
+                                          else if (key == "amount") parseNumber(value, amount);
+                                          else if (key == "method") method = value;
+                                          else if (key == "status") status = value;
+                                          else if (key == "transactionId") transactionId = value; });
+        return valid && matches;
+    }
+
+    string render() const
+    {
+        stringstream ss;
+        ss << "\n=== TRANSACTION LOG ===\n";
+        ss << "Timestamp: " << timestamp << "\n";
+        ss << "Customer Details:\n";
+        ss << "  Username: " << username << "\n";
+        ss << "  Email: " << email << "\n";
+        ss << "Car Details:\n";
+        ss << "  ID: " << carId << "\n";
+        ss << "  Brand: " << carName << "\n";
+        ss << "  Type: " << carType << "\n";
+        ss << "  Registration: " << registration << "\n";
+        ss << "Booking Details:\n";
+        ss << "  Booking ID: " << bookingId << "\n";
+        ss << "  Start Date: " << startDate << "\n";
+        ss << "  End Date: " << endDate << "\n";
+        ss << "  Duration: " << days << " days\n";
+        ss << "Payment Details:\n";
+        ss << "  Payment ID: " << paymentId << "\n";
+        ss << "  Amount: $" << fixed << setprecision(2) << amount << "\n";
+        ss << "  Method: " << method << "\n";
+        ss << "  Status: " << status << "\n";
+        ss << "  Transaction ID: " << transactionId << "\n";
+        ss << "Revenue Generated: $" << fixed << setprecision(2) << amount << "\n";
+        ss << "========================\n";
+        return ss.str();
+    }
+};
+
+struct BookingEvent
+{
+    string timestamp;
+    string action;
+    string username;
+    int bookingId = 0;
+    string carName;
+    string status;
+
+    string toJson() const
+    {
+        return JsonWriter()
+            .field("type", string("booking_update"))
+            .field("timestamp", timestamp)
+            .field("action", action)
+            .field("username", username)
+            .field("bookingId", bookingId)
+            .field("car", carName)
+            .field("status", status)
+            .line();
+    }
+
+    bool parse(string_view line)
+    {
+        bool matches = false;
+        bool valid = forEachJsonField(line, [this, &matches](string_view key, const string &value)
+                                      {
+                                          if (key == "type") matches = (value == "booking_update");
+                                          else if (key == "timestamp") timestamp = value;
+                                          else if (key == "action") action = value;
+                                          else if (key == "username") username = value;
+                                          else if (key == "bookingId") parseNumber(value, bookingId);
+                                          else if (key == "car") carName = value;
+                                          else if (key == "status") status = value; });
+        return valid && matches;
+    }
+
+    string render() const
+    {
+        stringstream ss;
+        ss << "\n=== BOOKING UPDATE ===\n";
+        ss << "Timestamp: " << timestamp << "\n";
+        ss << "Action: " << action << "\n";
+        ss << "Customer: " << username << "\n";
+        ss << "Booking Details:\n";
+        ss << "  Booking ID: " << bookingId << "\n";
+        ss << "  Car: " << carName << "\n";
+        ss << "  Status: " << status << "\n";
+        ss << "========================\n";
+        return ss.str();
+    }
+};
+
+struct PasswordChangeEvent
+{
+    string timestamp;
+    string username;
+    string email;
+
+    string toJson() const
+    {
+        return JsonWriter()
+            .field("type", string("password_change"))
+            .field("timestamp", timestamp)
+            .field("username", username)
+            .field("email", email)
+            .line();
+    }
+
+    bool parse(string_view line)
+    {
+        bool matches = false;
+        bool valid = forEachJsonField(line, [this, &matches](string_view key, const string &value)
+                                      {
+                                          if (key == "type") matches = (value == "password_change");
+                                          else if (key == "timestamp") timestamp = value;
+                                          else if (key == "username") username = value;
+                                          else if (key == "email") email = value; });
+        return valid && matches;
+    }
+
+    string render() const
+    {
+        stringstream ss;
+        ss << "\n=== PASSWORD CHANGE LOG ===\n";
+        ss << "Timestamp: " << timestamp << "\n";
+        ss << "User: " << username << "\n";
+        ss << "Email: " << email << "\n";
+        ss << "Password updated successfully.\n";
+        ss << "=============================\n";
+        return ss.str();
+    }
+};
+
+// Running report totals, folded in as events are logged
+struct GroupTotals
+{
+    int count = 0;
+    double amount = 0.0;
+};
+
+struct ReportAggregates
+{
+    double totalRevenue = 0.0;
+    map<string, GroupTotals> byMethod;   // Revenue by payment method
+    map<string, GroupTotals> byStatus;   // Booking and payment statuses
+    map<string, GroupTotals> byMonth;    // Paid bookings by start month (YYYY-MM)
+    map<string, GroupTotals> byCar;      // Paid bookings and revenue per car
+    map<string, GroupTotals> byCustomer; // Paid bookings and spending per customer
+
+    void apply(const TransactionEvent &event)
+    {
+        totalRevenue += event.amount;
+        add(byMethod[event.method], event.amount);
+        add(byStatus[event.status], 0.0);
+        add(byMonth[event.startDate.substr(0, 7)], event.amount);
+        add(byCar[event.carName], event.amount);
+        add(byCustomer[event.username], event.amount);
+    }
+
+    void apply(const BookingEvent &event)
+    {
+        add(byStatus[event.status], 0.0);
+    }
+
+    // Combine totals computed independently (e.g. per log shard)
+    void merge(const ReportAggregates &other)
+    {
+        totalRevenue += other.totalRevenue;
+        for (auto [target, source] : {pair{&byMethod, &other.byMethod}, pair{&byStatus, &other.byStatus},
+                                      pair{&byMonth, &other.byMonth}, pair{&byCar, &other.byCar},
+                                      pair{&byCustomer, &other.byCustomer}})
+        {
+            for (const auto &[key, totals] : *source)
+            {
+                GroupTotals &into = (*target)[key];
+                into.count += totals.count;
+                into.amount += totals.amount;
+            }
+        }
+    }
+
+private:
+    static void add(GroupTotals &totals, double amount)
+    {
+        totals.count++;
+        totals.amount += amount;
+    }
+};
+
+// Bounded lock-free multi-producer / single-consumer ring (sequence-numbered slots)
+template <typename T>
+class MpscRing
+{
+private:
+    struct Slot
+    {
+        atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t mask;
+    unique_ptr<Slot[]> slots;
+    atomic<size_t> enqueuePos{0};
+    size_t dequeuePos = 0; // Only touched by the consumer
+
+public:
+    // Capacity must be a power of two
+    explicit MpscRing(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity])
+    {
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            slots[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    // Blocks (yielding) only while the ring is full
+    void push(T value)
+    {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        Slot *slot;
+        while (true)
+        {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(memory_order_acquire);
+            if (seq == pos)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (seq < pos)
+            {
+                this_thread::yield(); // Full: wait for the consumer
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+            else
+            {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+        slot->value = move(value);
+        slot->sequence.store(pos + 1, memory_order_release);
+    }
+
+    bool pop(T &value)
+    {
+        Slot &slot = slots[dequeuePos & mask];
+        if (slot.sequence.load(memory_order_acquire) != dequeuePos + 1)
+        {
+            return false;
+        }
+        value = move(slot.value);
+        slot.sequence.store(dequeuePos + mask + 1, memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+
+    // Number of pushes claimed so far / pops completed so far
+    size_t claimed() const { return enqueuePos.load(memory_order_acquire); }
+    size_t consumed() const { return dequeuePos; }
+};
+
+// Logger class
+class Logger
+{
+private:
+    enum LogTarget
+    {
+        TransactionLog,
+        BookingLog,
+        LogTargetCount
+    };
+
+    struct LogEntry
+    {
+        LogTarget target = TransactionLog;
+        string content;
+    };
+
+    static Logger *instance;
+    mutex logMutex;
+    const string transactionLogFile = "transactions.jsonl";
+    const string bookingLogFile = "bookings.jsonl";
+    const string legacyTransactionLogFile = "transactions.txt";
+    const string legacyBookingLogFile = "bookings.txt";
+    const string aggregatesFile = "report_totals.jsonl";
+
+    mutex aggregatesMutex;
+    ReportAggregates aggregates;
+
+    // Producers push formatted entries; one writer thread owns the open files
+    static constexpr size_t ringCapacity = 4096;
+    static constexpr size_t flushBytes = 64 * 1024;
+    static constexpr chrono::milliseconds flushInterval{50};
+    static constexpr chrono::seconds aggregatesSaveInterval{5}; // at most this often, and only after new entries
+    MpscRing<LogEntry> ring{ringCapacity};
+    ofstream logFiles[LogTargetCount];
+    thread writer;
+    atomic<bool> running{false};  // producers may push; cleared first by shutdown
+    atomic<size_t> producers{0};  // producers between checking 'running' and finishing a push
+    atomic<bool> stopping{false}; // set once no producer can push again; the writer drains and exits
+    atomic<int> flushWaiters{0};
+    mutex wakeMutex;              // guards the two waits below and the fields they test
+    condition_variable wake;      // writer idles here between time-based flushes
+    condition_variable flushed;   // flush() callers wait here for writtenPos to pass their entries
+    size_t writtenPos = 0;        // entries both written and flushed to the OS
+    bool writerDone = false;
+
+    Logger()
+    {
+        importLegacyLog(legacyTransactionLogFile, transactionLogFile);
+        importLegacyLog(legacyBookingLogFile, bookingLogFile);
+        loadAggregates();
+        running = true;
+        writer = thread(&Logger::writerLoop, this);
+    }
+
+    // One-time conversion of the old free-text log blocks into event records
+    void importLegacyLog(const string &legacyFile, const string &eventFile)
+    {
+        if (filesystem::exists(eventFile) || !filesystem::exists(legacyFile))
+        {
+            return;
+        }
+        ifstream inFile(legacyFile);
+        ofstream outFile(eventFile);
+        if (!inFile || !outFile)
+        {
+            return;
+        }
+
+        string header;
+        map<string, string> fields;
+        auto number = [&fields](const string &key, auto &value)
+        {
+            string text = fields[key];
+            size_t start = text.find_first_not_of('$');
+            if (start != string::npos)
+            {
+                parseNumber(string_view(text).substr(start), value);
+            }
+        };
+
+        string line;
+        while (getline(inFile, line))
+        {
+            size_t start = line.find_first_not_of(' ');
+            if (start == string::npos)
+            {
+                continue;
+            }
+            line = line.substr(start);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (line.rfind("===", 0) != 0)
+            {
+                size_t sep = line.find(": ");
+                if (sep != string::npos)
+                {
+                    fields[line.substr(0, sep)] = line.substr(sep + 2);
+                }
+                continue;
+            }
+            if (header.empty())
+            {
+                header = line;
+                continue;
+            }
+
+            // Closing rule: emit the collected block
+            if (header == "=== TRANSACTION LOG ===")
+            {
+                TransactionEvent event;
+                event.timestamp = fields["Timestamp"];
+                event.username = fields["Username"];
+                event.email = fields["Email"];
+                number("ID", event.carId);
+                event.carName = fields["Brand"];
+                event.carType = fields["Type"];
+                event.registration = fields["Registration"];
+                number("Booking ID", event.bookingId);
+                event.startDate = fields["Start Date"];
+                event.endDate = fields["End Date"];
+                number("Duration", event.days);
+                number("Payment ID", event.paymentId);
+                number("Amount", event.amount);
+                event.method = fields["Method"];
+                event.status = fields["Status"];
+                event.transactionId = fields["Transaction ID"];
+                outFile << event.toJson();
+            }
+            else if (header == "=== BOOKING UPDATE ===")
+            {
+                BookingEvent event;
+                event.timestamp = fields["Timestamp"];
+                event.action = fields["Action"];
+                event.username = fields["Customer"];
+                number("Booking ID", event.bookingId);
+                event.carName = fields["Car"];
+                event.status = fields["Status"];
+                outFile << event.toJson();
+            }
+            else if (header == "=== PASSWORD CHANGE LOG ===")
+            {
+                PasswordChangeEvent event;
+                event.timestamp = fields["Timestamp"];
+                event.username = fields["User"];
+                event.email = fields["Email"];
+                outFile << event.toJson();
+            }
+            header.clear();
+            fields.clear();
+        }
+    }
+
+    static uintmax_t sizeOf(const string &filename)
+    {
+        error_code ec;
+        uintmax_t size = filesystem::file_size(filename, ec);
+        return ec ? 0 : size;
+    }
+
+    // Fold every event of this type found after 'offset' into the totals. Large logs are
+    // cut into line-aligned shards, each aggregated on its own thread and merged at the end.
+    // 'workers' caps the threads (0: one per hardware thread).
+    template <typename Event>
+    size_t foldLog(LogTarget target, uintmax_t offset, size_t workers = 0)
+    {
+        const string &filename = fileFor(target);
+        uintmax_t end = sizeOf(filename);
+        if (offset >= end)
+        {
+            return 0;
+        }
+
+        constexpr uintmax_t minShardBytes = 4 * 1024 * 1024;
+        if (workers == 0)
+        {
+            workers = max(1u, thread::hardware_concurrency());
+        }
+        size_t parts = static_cast<size_t>(min<uintmax_t>(workers, (end - offset) / minShardBytes + 1));
+        vector<uintmax_t> splits = lineAlignedSplits(filename, offset, end, parts);
+
+        vector<ReportAggregates> shards(splits.size() - 1);
+        vector<thread> threads;
+        for (size_t i = 0; i < shards.size(); ++i)
+        {
+            threads.emplace_back([&filename, &splits, &shards, i]
+                                 { forEachLineInRange(filename, splits[i], splits[i + 1], [&shards, i](string_view line)
+                                                      {
+                                                          Event event;
+                                                          if (event.parse(line))
+                                                          {
+                                                              shards[i].apply(event);
+                                                          } }); });
+        }
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            threads[i].join();
+            aggregates.merge(shards[i]);
+        }
+        return shards.size();
+    }
+
+    // Start from the saved totals and catch up on anything logged after they were taken
+    void loadAggregates()
+    {
+        uintmax_t transactionOffset = 0;
+        uintmax_t bookingOffset = 0;
+        MappedFile file(aggregatesFile);
+        forEachLine(file, [&](string_view line)
+                    {
+                        string group;
+                        string key;
+                        GroupTotals totals;
+                        forEachJsonField(line, [&](string_view field, const string &value)
+                                         {
+                                             if (field == "group") group = value;
+                                             else if (field == "key") key = value;
+                                             else if (field == "count") parseNumber(value, totals.count);
+                                             else if (field == "amount") parseNumber(value, totals.amount);
+                                             else if (field == "transactions") parseNumber(value, transactionOffset);
+                                             else if (field == "bookings") parseNumber(value, bookingOffset); });
+                        if (group == "revenue") aggregates.totalRevenue = totals.amount;
+                        else if (group == "method") aggregates.byMethod[key] = totals;
+                        else if (group == "status") aggregates.byStatus[key] = totals;
+                        else if (group == "month") aggregates.byMonth[key] = totals;
+                        else if (group == "car") aggregates.byCar[key] = totals;
+                        else if (group == "customer") aggregates.byCustomer[key] = totals; });
+
+        // A log shorter than the snapshot remembers means it was replaced: rebuild
+        if (transactionOffset > sizeOf(transactionLogFile) || bookingOffset > sizeOf(bookingLogFile))
+        {
+            aggregates = ReportAggregates();
+            transactionOffset = bookingOffset = 0;
+        }
+        foldLog<TransactionEvent>(TransactionLog, transactionOffset);
+        foldLog<BookingEvent>(BookingLog, bookingOffset);
+    }
+
+    // Persist totals together with the log sizes they cover
+    void saveAggregates(const ReportAggregates &totals, uintmax_t transactionOffset, uintmax_t bookingOffset)
+    {
+        const string tmpFile = aggregatesFile + ".tmp";
+        {
+            ofstream outFile(tmpFile);
+            if (!outFile)
+            {
+                cerr << "Error: Could not save report totals!" << endl;
+                return;
+            }
+            outFile << JsonWriter()
+                           .field("group", string("offsets"))
+                           .field("transactions", static_cast<int64_t>(transactionOffset))
+                           .field("bookings", static_cast<int64_t>(bookingOffset))
+                           .line();
+            outFile << JsonWriter().field("group", string("revenue")).field("amount", totals.totalRevenue).line();
+            auto writeGroup = [&outFile](const string &group, const map<string, GroupTotals> &totals)
+            {
+                for (const auto &[key, value] : totals)
+                {
+                    outFile << JsonWriter()
+                                   .field("group", group)
+                                   .field("key", key)
+                                   .field("count", value.count)
+                                   .field("amount", value.amount)
+                                   .line();
+                }
+            };
+            writeGroup("method", totals.byMethod);
+            writeGroup("status", totals.byStatus);
+            writeGroup("month", totals.byMonth);
+            writeGroup("car", totals.byCar);
+            writeGroup("customer", totals.byCustomer);
+            if (!outFile.flush())
+            {
+                cerr << "Error: Could not save report totals!" << endl;
+                return;
+            }
+        }
+        error_code ec;
+        if (syncFile(tmpFile))
+        {
+            filesystem::rename(tmpFile, aggregatesFile, ec);
+        }
+        else
+        {
+            ec = make_error_code(errc::io_error);
+        }
+        if (ec)
+        {
+            cerr << "Error: Could not save report totals: " << ec.message() << endl;
+        }
+    }
+
+    // Write one queued entry to its file; returns the bytes written
+    size_t writeEntry(const LogEntry &entry)
+    {
+        ofstream &file = logFiles[entry.target];
+        if (!file.is_open())
+        {
+            file.open(fileFor(entry.target), ios::app);
+            if (!file)
+            {
+                cerr << "Error: Could not open log file: " << fileFor(entry.target) << endl;
+                return 0;
+            }
+        }
+        file << entry.content;
+        return entry.content.size();
+    }
+
+    // Writer thread only. With the totals lock held no logged event is between being
+    // counted and being queued, so once everything queued so far is written the log sizes
+    // match the totals exactly. A logger or rebuild holding the lock makes it skip;
+    // the next flush tries again.
+    bool snapshotAggregates()
+    {
+        unique_lock<mutex> lock(aggregatesMutex, try_to_lock);
+        if (!lock.owns_lock())
+        {
+            return false;
+        }
+        LogEntry entry;
+        for (size_t end = ring.claimed(); ring.consumed() < end;)
+        {
+            if (ring.pop(entry))
+            {
+                writeEntry(entry);
+            }
+            else
+            {
+                this_thread::yield(); // A password change still being queued
+            }
+        }
+        flushFiles();
+        uintmax_t transactionOffset = sizeOf(transactionLogFile);
+        uintmax_t bookingOffset = sizeOf(bookingLogFile);
+        ReportAggregates totals = aggregates;
+        lock.unlock();
+
+        saveAggregates(totals, transactionOffset, bookingOffset);
+        return true;
+    }
+
+    // Single streaming pass over a log, decoding each record as either event type
+    template <typename First, typename Second, typename FirstVisitor, typename SecondVisitor>
+    void scanLog(LogTarget target, FirstVisitor &&visitFirst, SecondVisitor &&visitSecond)
+    {
+        flush();
+        lock_guard<mutex> lock(logMutex);
+        forEachLineInFile(fileFor(target), 0, [&](string_view line)
+                          {
+                              First first;
+                              if (first.parse(line))
+                              {
+                                  visitFirst(first);
+                                  return;
+                              }
+                              Second second;
+                              if (second.parse(line))
+                              {
+                                  visitSecond(second);
+                              } });
+    }
+
+    const string &fileFor(LogTarget target) const
+    {
+        return target == TransactionLog ? transactionLogFile : bookingLogFile;
+    }
+
+    void flushFiles()
+    {
+        for (auto &file : logFiles)
+        {
+            if (file.is_open())
+            {
+                file.flush();
+            }
+        }
+    }
+
+    void writerLoop()
     {
-        cout << "Payment ID: " << id << " | Booking ID: " << bookingId
-             << " | Transaction: " << transactionId
-             << "\nAmount: $" << fixed << setprecision(2) << amount
-             << " | Date: " << date << " | Method: " << method
-             << "\nStatus: " << status << endl;
-    }
-};
-// Logger class
-class Logger
-{
-private:
-    static Logger *instance;
-    mutex logMutex;
-    const string transactionLogFile = "transactions.txt";
-    const string bookingLogFile = "bookings.txt";
+        auto lastFlush = chrono::steady_clock::now();
+        auto lastSave = lastFlush;
+        size_t savedPos = ring.consumed();
+        size_t pendingBytes = 0;
+        LogEntry entry;
+
+        while (true)
+        {
+            bool stop = stopping.load(memory_order_acquire);
+            bool drained = true;
+            while (ring.pop(entry))
+            {
+                drained = false;
+                pendingBytes += writeEntry(entry);
+                if (pendingBytes >= flushBytes)
+                {
+                    break;
+                }
+            }
+
+            auto now = chrono::steady_clock::now();
+            if (pendingBytes >= flushBytes || now - lastFlush >= flushInterval ||
+                flushWaiters.load(memory_order_acquire) > 0 || stop)
+            {
+                flushFiles();
+                pendingBytes = 0;
+                lastFlush = now;
+                // Keep the saved report totals recent, so a crash costs a short catch-up fold
+                if (!stop && ring.consumed() != savedPos && now - lastSave >= aggregatesSaveInterval &&
+                    snapshotAggregates())
+                {
+                    lastSave = now;
+                    savedPos = ring.consumed();
+                }
+                {
+                    lock_guard<mutex> lock(wakeMutex);
+                    writtenPos = ring.consumed();
+                }
+                flushed.notify_all();
+            }
 
-    Logger() = default;
+            if (stop && ring.consumed() == ring.claimed())
+            {
+                break;
+            }
+            if (drained)
+            {
+                unique_lock<mutex> lock(wakeMutex);
+                wake.wait_for(lock, flushInterval, [this]
+                              { return flushWaiters.load() > 0 || stopping.load(); });
+            }
+        }
+        {
+            lock_guard<mutex> lock(wakeMutex);
+            writerDone = true;
+        }
+        flushed.notify_all();
+    }
 
     string getCurrentTime()
     {
-        time_t now = time(0);
-        tm *ltm = localtime(&now);
+        tm local = localTime(time(0));
+        const tm *ltm = &local;
         stringstream ss;
         ss << setw(2) << setfill('0') << ltm->tm_hour << ":"
            << setw(2) << setfill('0') << ltm->tm_min << ":"
@@ -346,25 +3339,87 @@ private:
         return ss.str();
     }
 
-    void writeToLog(const string &filename, const string &content)
+    void writeToLog(LogTarget target, string content)
     {
+        // Counting in before checking 'running' (both seq_cst) means shutdown either sees
+        // this producer and waits for its push, or this producer sees the shutdown
+        producers.fetch_add(1);
+        if (running.load())
+        {
+            ring.push(LogEntry{target, move(content)});
+            producers.fetch_sub(1);
+            return;
+        }
+        producers.fetch_sub(1);
+
+        // After shutdown fall back to a direct write
         lock_guard<mutex> lock(logMutex);
-        ofstream outFile(filename, ios::app);
+        ofstream outFile(fileFor(target), ios::app);
         if (!outFile)
         {
-            cerr << "Error: Could not open log file: " << filename << endl;
+            cerr << "Error: Could not open log file: " << fileFor(target) << endl;
             return;
         }
         outFile << content;
     }
 
 public:
-    static Logger *getInstance()
+    ~Logger()
+    {
+        shutdown();
+    }
+
+    // Block until everything logged so far has reached the files. Any number of threads
+    // may wait at once; each is released when the writer's flush passes its entries.
+    void flush()
+    {
+        size_t target = ring.claimed();
+        flushWaiters.fetch_add(1);
+        {
+            unique_lock<mutex> lock(wakeMutex);
+            wake.notify_one();
+            flushed.wait(lock, [this, target]
+                         { return writerDone || writtenPos >= target; });
+        }
+        flushWaiters.fetch_sub(1);
+    }
+
+    // Drain the queue, flush and stop the writer thread
+    void shutdown()
     {
-        if (!instance)
+        unique_lock<mutex> lock(logMutex);
+        if (!running.exchange(false))
+        {
+            return;
+        }
+        // Pushes already past the 'running' check must land before the writer may exit
+        while (producers.load() != 0)
+        {
+            this_thread::yield();
+        }
         {
-            instance = new Logger();
+            lock_guard<mutex> wakeLock(wakeMutex);
+            stopping = true;
         }
+        wake.notify_one();
+        writer.join();
+        for (auto &file : logFiles)
+        {
+            file.close();
+        }
+        // Loggers take the totals lock before logMutex (for a direct write)
+        lock.unlock();
+
+        lock_guard<mutex> totalsLock(aggregatesMutex);
+        saveAggregates(aggregates, sizeOf(transactionLogFile), sizeOf(bookingLogFile));
+    }
+
+    // Safe to call from any thread; the writer thread is started exactly once
+    static Logger *getInstance()
+    {
+        static once_flag created;
+        call_once(created, []
+                  { instance = new Logger(); });
         return instance;
     }
 
@@ -372,114 +3427,94 @@ public:
                         const Car &car, const Booking &booking,
                         const Payment &payment)
     {
-        stringstream ss;
-        ss << "\n=== TRANSACTION LOG ===\n";
-        ss << "Timestamp: " << getCurrentDate() << " " << getCurrentTime() << "\n";
-        ss << "Customer Details:\n";
-        ss << "  Username: " << username << "\n";
-        ss << "  Email: " << email << "\n";
-        ss << "Car Details:\n";
-        ss << "  ID: " << car.getId() << "\n";
-        ss << "  Brand: " << car.getBrand() << " " << car.getModel() << "\n";
-        ss << "  Type: " << car.getType() << "\n";
-        ss << "  Registration: " << car.getRegistrationNumber() << "\n";
-        ss << "Booking Details:\n";
-        ss << "  Booking ID: " << booking.getId() << "\n";
-        ss << "  Start Date: " << booking.getStartDate() << "\n";
-        ss << "  End Date: " << booking.getEndDate() << "\n";
-        ss << "  Duration: " << calculateDaysBetweenDates(booking.getStartDate(), booking.getEndDate()) << " days\n";
-        ss << "Payment Details:\n";
-        ss << "  Payment ID: " << payment.getId() << "\n";
-        ss << "  Amount: $" << fixed << setprecision(2) << payment.getAmount() << "\n";
-        ss << "  Method: " << payment.getMethod() << "\n";
-        ss << "  Status: " << payment.getStatus() << "\n";
-        ss << "  Transaction ID: " << payment.getTransactionId() << "\n";
-        ss << "Revenue Generated: $" << fixed << setprecision(2) << payment.getAmount() << "\n";
-        ss << "========================\n";
-
-        writeToLog(transactionLogFile, ss.str());
+        TransactionEvent event;
+        event.timestamp = getCurrentDate() + " " + getCurrentTime();
+        event.username = username;
+        event.email = email;
+        event.carId = car.getId();
+        event.carName = car.getBrand() + " " + car.getModel();
+        event.carType = car.getType();
+        event.registration = car.getRegistrationNumber();
+        event.bookingId = booking.getId();
+        event.startDate = booking.getStartDate().toString();
+        event.endDate = booking.getEndDate().toString();
+        event.days = booking.getEndDate() - booking.getStartDate();
+        event.paymentId = payment.getId();
+        event.amount = payment.getAmount();
+        event.method = payment.getMethod();
+        event.status = payment.getStatus();
+        event.transactionId = payment.getTransactionId();
+
+        // Queued under the lock, so a rebuild never sees an event in the totals but not the log
+        lock_guard<mutex> lock(aggregatesMutex);
+        aggregates.apply(event);
+        writeToLog(TransactionLog, event.toJson());
     }
 
     void logBookingUpdate(const string &username, const string &action,
                           const Booking &booking, const Car &car)
     {
-        stringstream ss;
-        ss << "\n=== BOOKING UPDATE ===\n";
-        ss << "Timestamp: " << getCurrentDate() << " " << getCurrentTime() << "\n";
-        ss << "Action: " << action << "\n";
-        ss << "Customer: " << username << "\n";
-        ss << "Booking Details:\n";
-        ss << "  Booking ID: " << booking.getId() << "\n";
-        ss << "  Car: " << car.getBrand() << " " << car.getModel() << "\n";
-        ss << "  Status: " << booking.getStatus() << "\n";
-        ss << "========================\n";
-
-        writeToLog(bookingLogFile, ss.str());
+        BookingEvent event;
+        event.timestamp = getCurrentDate() + " " + getCurrentTime();
+        event.action = action;
+        event.username = username;
+        event.bookingId = booking.getId();
+        event.carName = car.getBrand() + " " + car.getModel();
+        event.status = statusName(booking.getStatus());
+
+        lock_guard<mutex> lock(aggregatesMutex);
+        aggregates.apply(event);
+        writeToLog(BookingLog, event.toJson());
     }
 
     void logPasswordChange(const string &username, const string &email)
     {
-        stringstream ss;
-        ss << "\n=== PASSWORD CHANGE LOG ===\n";
-        ss << "Timestamp: " << getCurrentDate() << " " << getCurrentTime() << "\n";
-        ss << "User: " << username << "\n";
-        ss << "Email: " << email << "\n";
-        ss << "Password updated successfully.\n";
-        ss << "=============================\n";
+        PasswordChangeEvent event;
+        event.timestamp = getCurrentDate() + " " + getCurrentTime();
+        event.username = username;
+        event.email = email;
 
-        writeToLog(bookingLogFile, ss.str()); // Password changes go to booking log as they're user-related
+        writeToLog(BookingLog, event.toJson()); // Password changes go to booking log as they're user-related
     }
 
-    vector<string> readTransactionLogs()
+    // Recompute the totals from the full logs using a parallel scan on up to 'workers'
+    // threads (0: one per hardware thread); returns the shard count. Holding the totals lock
+    // from the flush to the end of the fold keeps new events out until it is done.
+    size_t rebuildReportAggregates(size_t workers = 0)
     {
-        lock_guard<mutex> lock(logMutex);
-        vector<string> logs;
-        ifstream inFile(transactionLogFile);
-        if (!inFile)
-        {
-            return logs;
-        }
-
-        string line;
-        while (getline(inFile, line))
-        {
-            logs.push_back(line);
-        }
-        return logs;
+        lock_guard<mutex> lock(aggregatesMutex);
+        flush();
+        aggregates = ReportAggregates();
+        size_t shards = foldLog<TransactionEvent>(TransactionLog, 0, workers);
+        shards += foldLog<BookingEvent>(BookingLog, 0, workers);
+        return shards;
     }
 
-    vector<string> readBookingLogs()
+    // Snapshot of the running report totals; O(number of groups)
+    ReportAggregates getReportAggregates()
     {
-        lock_guard<mutex> lock(logMutex);
-        vector<string> logs;
-        ifstream inFile(bookingLogFile);
-        if (!inFile)
-        {
-            return logs;
-        }
-
-        string line;
-        while (getline(inFile, line))
-        {
-            logs.push_back(line);
-        }
-        return logs;
+        lock_guard<mutex> lock(aggregatesMutex);
+        return aggregates;
     }
 
-    // Combined logs for backward compatibility
-    vector<string> readLogs()
+    // Streaming readers: records are decoded one at a time and never collected
+    template <typename Visitor>
+    void forEachTransaction(Visitor &&visit)
     {
-        vector<string> allLogs;
-
-        // Read transaction logs
-        vector<string> transLogs = readTransactionLogs();
-        allLogs.insert(allLogs.end(), transLogs.begin(), transLogs.end());
+        scanLog<TransactionEvent, TransactionEvent>(TransactionLog, visit, [](const TransactionEvent &) {});
+    }
 
-        // Read booking logs
-        vector<string> bookLogs = readBookingLogs();
-        allLogs.insert(allLogs.end(), bookLogs.begin(), bookLogs.end());
+    template <typename Visitor>
+    void forEachBookingUpdate(Visitor &&visit)
+    {
+        forEachBookingLogEvent(visit, [](const PasswordChangeEvent &) {});
+    }
 
-        return allLogs;
+    // The booking log also carries password changes; one pass serves both
+    template <typename UpdateVisitor, typename PasswordVisitor>
+    void forEachBookingLogEvent(UpdateVisitor &&visitUpdate, PasswordVisitor &&visitPasswordChange)
+    {
+        scanLog<BookingEvent, PasswordChangeEvent>(BookingLog, visitUpdate, visitPasswordChange);
     }
 };
 
@@ -603,10 +3638,6 @@ class CarRentalSystem;
 // Customer class
 class Customer : public User
 {
-private:
-    vector<Booking> bookings;
-    vector<Payment> payments;
-
 public:
     Customer(int id, const string &username, const string &password, const string &email)
         : User(id, username, password, email, "customer") {}
@@ -639,133 +3670,543 @@ public:
     void generateReports() const;
 };
 
-// Singleton Pattern: CarRentalSystem
-class CarRentalSystem
-{
-private:
-    static CarRentalSystem *instance;
-    vector<unique_ptr<User>> users;
-    vector<Car> cars;
-    vector<Booking> bookings;
-    vector<Payment> payments;
-    int nextUserId = 1;
-    int nextCarId = 1;
-    int nextBookingId = 1;
-    int nextPaymentId = 1;
-    const string userDataFile = "users.dat";
-    const string carDataFile = "cars.dat";
+// Singleton Pattern: CarRentalSystem
+class CarRentalSystem
+{
+private:
+    static CarRentalSystem *instance;
+    TableLock tables; // shared by readers, exclusive for writers; guards everything below
+    vector<unique_ptr<User>> users;
+    unordered_map<string, User *> usersByName;
+    unordered_map<int, User *> usersById;
+    vector<unique_ptr<Car>> cars;
+    unordered_map<int, size_t> carIndex; // car id -> slot in cars
+    unordered_map<int, ScheduleCell> schedules; // car id -> reserved date ranges
+    FleetAvailability availability;            // fleet-wide per-day booking bitmap
+    CarSearchIndex searchIndex;                // brand/type/price indexes for searchCars
+    FleetColumns columns;                      // scan-friendly copy of filter fields, by slot
+    deque<Booking> bookings;   // the one copy of every booking; appends never move entries
+    BookingIndex bookingIndex; // bookings by status, car and user; payment per booking
+    deque<Payment> payments;
+    unordered_map<int, size_t> bookingAt; // booking id -> index in 'bookings'
+    unordered_map<int, size_t> paymentAt; // payment id -> index in 'payments'
+    RecordStore<BookingRecord> bookingStore{"bookings.dat"};
+    RecordStore<PaymentRecord> paymentStore{"payments.dat"};
+    int nextUserId = 1;
+    int nextCarId = 1;
+    IdAllocator bookingIds{"booking_ids.dat"};
+    IdAllocator paymentIds{"payment_ids.dat"};
+    const string userDataFile = "users.dat";
+    const string carDataFile = "cars.dat";
+    const string carJournalFile = "cars.journal";
+    const string compactingJournalFile = "cars.journal.compacting"; // covered by the snapshot being written
+    const size_t carJournalCompactMin = 1024;
+    static constexpr size_t scanRatio = 8; // findCars scans columns past 1/8 of the fleet
+    ofstream carJournal;
+    size_t carJournalEntries = 0;
+    thread compactor; // writes cars.dat from a fleet copy, off the table lock
+    atomic<bool> compacting{false};
+
+    // Private constructor for singleton
+    CarRentalSystem()
+    {
+        loadUserData();
+        loadCarData();
+
+        // Initialize with some sample data if no users exist
+        if (users.empty())
+        {
+            insertUser(make_unique<Admin>(nextUserId++, "admin", "admin123", "admin@carrental.com"));
+            insertUser(make_unique<Customer>(nextUserId++, "john", "john123", "john@example.com"));
+            insertUser(make_unique<Customer>(nextUserId++, "alice", "alice123", "alice@example.com"));
+            saveUserData();
+        }
+
+        // Only add sample cars if no cars exist
+        if (cars.empty())
+        {
+            insertCar(Car(nextCarId++, "Toyota", "Camry", "Sedan", 2022, "Blue", 50.0, "ABC123"));
+            insertCar(Car(nextCarId++, "Honda", "Civic", "Sedan", 2021, "Red", 45.0, "DEF456"));
+            insertCar(Car(nextCarId++, "Ford", "Explorer", "SUV", 2023, "Black", 70.0, "GHI789"));
+            insertCar(Car(nextCarId++, "Chevrolet", "Silverado", "Truck", 2020, "White", 85.0, "JKL012"));
+            saveCarData();
+        }
+
+        availability.rollTo(Date::today().dayNumber());
+        loadBookingData();
+    }
+
+    // Restore bookings and payments
+    void loadBookingData()
+    {
+        // Bookings already over claim no dates: schedules only hold today and beyond
+        int today = Date::today().dayNumber();
+        bookingStore.load([this, today](const BookingRecord &record)
+                          {
+                              bookingAt[record.id] = bookings.size();
+                              bookings.push_back(Booking::fromRecord(record));
+                              if (bookings.back().getEndDate().dayNumber() > today && reserveDates(bookings.back()))
+                              {
+                                  markBusy(bookings.back());
+                              }
+                              bookingIndex.add(bookings.back()); });
+
+        paymentStore.load([this](const PaymentRecord &record)
+                          {
+                              paymentAt[record.id] = payments.size();
+                              payments.push_back(Payment::fromRecord(record));
+                              bookingIndex.addPayment(record.bookingId, record.id); });
+
+        // Ids from earlier random allocation stay taken
+        int maxBookingId = 0, maxPaymentId = 0;
+        for (const auto &booking : bookings)
+        {
+            maxBookingId = max(maxBookingId, booking.getId());
+        }
+        for (const auto &payment : payments)
+        {
+            maxPaymentId = max(maxPaymentId, payment.getId());
+        }
+        bookingIds.reserveBelow(static_cast<uint64_t>(maxBookingId) + 1);
+        paymentIds.reserveBelow(static_cast<uint64_t>(maxPaymentId) + 1);
+    }
+
+    void loadUserData()
+    {
+        // A missing file just means no users yet
+        MappedFile file(userDataFile);
+        size_t expected = countLines(file);
+        users.reserve(expected);
+        usersByName.reserve(expected);
+        usersById.reserve(expected);
+        forEachLine(file, [this](string_view line)
+                    {
+                        array<string_view, 5> fields;
+                        int id;
+                        if (splitFields(line, fields) != fields.size() || !parseNumber(fields[0], id))
+                        {
+                            return; // Skip invalid lines
+                        }
+                        string username(fields[1]);
+                        string password(fields[2]);
+                        string email(fields[3]);
+                        if (fields[4] == "admin")
+                        {
+                            insertUser(make_unique<Admin>(id, username, password, email));
+                        }
+                        else
+                        {
+                            insertUser(make_unique<Customer>(id, username, password, email));
+                        }
+                        // Update nextUserId to be higher than any existing ID
+                        if (id >= nextUserId)
+                        {
+                            nextUserId = id + 1;
+                        }
+                    });
+    }
+
+    void saveUserData()
+    {
+        ofstream outFile(userDataFile);
+        if (!outFile)
+        {
+            cerr << "Error: Could not open user data file for writing!" << endl;
+            return;
+        }
+        for (const auto &user : users)
+        {
+            outFile << user->serialize() << endl;
+        }
+    }
+
+    // Status text from cars.dat or the journal; anything unrecognised keeps the car out of service
+    static CarStatus savedCarStatus(string_view text)
+    {
+        CarStatus status = CarStatus::Maintenance;
+        parseCarStatus(text, status);
+        return status;
+    }
+
+    // Build a car from a serialized record (id,brand,model,type,year,color,price,reg[,status])
+    void insertCarFields(const string_view *fields, size_t count)
+    {
+        int id, year;
+        double price;
+        if (count < 8 || !parseNumber(fields[0], id) || !parseNumber(fields[4], year) ||
+            !parseNumber(fields[6], price))
+        {
+            return;
+        }
+        if (id >= nextCarId)
+        {
+            nextCarId = id + 1;
+        }
+        // A journal replayed over a snapshot that already holds the car (a crash between
+        // writing cars.dat and truncating the journal) re-adds it; the snapshot wins
+        if (carIndex.count(id))
+        {
+            return;
+        }
+        Car car(id, string(fields[1]), string(fields[2]), string(fields[3]),
+                year, string(fields[5]), price, string(fields[7]),
+                count > 8 ? savedCarStatus(fields[8]) : CarStatus::Available);
+        insertCar(car);
+    }
+
+    void loadCarData()
+    {
+        {
+            MappedFile file(carDataFile);
+            size_t expected = countLines(file);
+            cars.reserve(expected);
+            carIndex.reserve(expected);
+            forEachLine(file, [this](string_view line)
+                        {
+                            array<string_view, 9> fields;
+                            size_t count = splitFields(line, fields);
+                            insertCarFields(fields.data(), min(count, fields.size())); });
+        }
+
+        // A compaction cut short leaves its journal behind; it predates the live one
+        size_t replayed = replayCarJournal(compactingJournalFile) + replayCarJournal(carJournalFile);
+        if (replayed > 0)
+        {
+            saveCarData();
+        }
+    }
+
+    // Apply mutations recorded in a journal over the snapshot; returns how many applied
+    size_t replayCarJournal(const string &journalFile)
+    {
+        size_t replayed = 0;
+        {
+            MappedFile file(journalFile);
+            forEachLine(file, [this, &replayed](string_view line)
+                        {
+                            array<string_view, 10> fields;
+                            size_t count = min(splitFields(line, fields), fields.size());
+                            int carId;
+                            if (count < 2)
+                            {
+                                return; // Torn or empty entry
+                            }
+                            if (fields[0] == "A")
+                            {
+                                insertCarFields(fields.data() + 1, count - 1);
+                            }
+                            else if (!parseNumber(fields[1], carId))
+                            {
+                                return;
+                            }
+                            else if (fields[0] == "R")
+                            {
+                                eraseCar(carId);
+                            }
+                            else if (count >= 3 && carIndex.count(carId))
+                            {
+                                double price;
+                                if (fields[0] == "S")
+                                {
+                                    carById(carId).restoreStatus(savedCarStatus(fields[2]));
+                                    syncCarStatus(carId);
+                                }
+                                else if (fields[0] == "P" && parseNumber(fields[2], price))
+                                {
+                                    applyCarPrice(carId, price);
+                                }
+                            }
+                            replayed++; });
+        }
+        return replayed;
+    }
+
+    // Append one mutation to the journal; compact once it outgrows the fleet
+    void appendCarJournal(const string &entry)
+    {
+        if (!carJournal.is_open())
+        {
+            carJournal.open(carJournalFile, ios::app);
+            if (!carJournal)
+            {
+                cerr << "Error: Could not open car journal, writing full snapshot instead." << endl;
+                saveCarData();
+                return;
+            }
+        }
+        carJournal << entry << '\n';
+        carJournal.flush();
+
+        if (++carJournalEntries >= max(carJournalCompactMin, cars.size()) && !compacting)
+        {
+            startCompaction();
+        }
+    }
+
+    vector<Car> fleetSnapshot() const
+    {
+        vector<Car> snapshot;
+        snapshot.reserve(cars.size());
+        for (const auto &car : cars)
+        {
+            snapshot.push_back(*car);
+        }
+        return snapshot;
+    }
+
+    // Replace cars.dat through a synced temp file; reports and returns false on failure
+    bool writeCarSnapshot(const vector<Car> &snapshot) const
+    {
+        const string tmpFile = carDataFile + ".tmp";
+        {
+            ofstream outFile(tmpFile);
+            if (!outFile)
+            {
+                cerr << "Error: Could not open car data file for writing at: "
+                     << filesystem::absolute(tmpFile).string() << endl;
+                return false;
+            }
+
+            for (const Car &car : snapshot)
+            {
+                outFile << car.serialize() << '\n';
+            }
+            if (!outFile.flush())
+            {
+                cerr << "Error: Could not write car data file: " << tmpFile << endl;
+                return false;
+            }
+        }
+
+        error_code ec;
+        if (!syncFile(tmpFile))
+        {
+            cerr << "Error: Could not sync car data file: " << tmpFile << endl;
+            return false;
+        }
+        filesystem::rename(tmpFile, carDataFile, ec);
+        if (ec)
+        {
+            cerr << "Error: Could not replace car data file: " << ec.message() << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Called under the write lock. Copies the fleet and moves the journal aside, which is
+    // all the lock has to cover; a background thread writes the snapshot and then drops
+    // the old journal. New mutations go to a fresh journal meanwhile, so a crash at any
+    // point replays at most what the snapshot already holds.
+    void startCompaction()
+    {
+        carJournal.close();
+        if (filesystem::exists(compactingJournalFile))
+        {
+            // An earlier background write failed: its journal must survive until a snapshot
+            // covers it, so fold everything into cars.dat here instead
+            saveCarData();
+            return;
+        }
+        syncFile(carJournalFile);
+        error_code ec;
+        filesystem::rename(carJournalFile, compactingJournalFile, ec);
+        if (ec)
+        {
+            cerr << "Error: Could not rotate car journal: " << ec.message() << endl;
+            carJournal.open(carJournalFile, ios::app);
+            return;
+        }
+        carJournal.open(carJournalFile, ios::trunc);
+        carJournalEntries = 0;
+
+        if (compactor.joinable())
+        {
+            compactor.join(); // finished: 'compacting' was clear
+        }
+        compacting = true;
+        compactor = thread([this, snapshot = fleetSnapshot()]
+                           {
+                               if (writeCarSnapshot(snapshot))
+                               {
+                                   error_code removeError;
+                                   filesystem::remove(compactingJournalFile, removeError);
+                               }
+                               compacting = false; });
+    }
+
+    // Append a user and register it in the username and id indexes (no save)
+    void insertUser(unique_ptr<User> user)
+    {
+        usersByName[user->getUsername()] = user.get();
+        usersById[user->getId()] = user.get();
+        users.push_back(move(user));
+    }
 
-    // Private constructor for singleton
-    CarRentalSystem()
+    // Append a car and record its slot in the id index (no save). Ids are unique.
+    Car &insertCar(const Car &car)
     {
-        loadUserData();
-        loadCarData();
+        if (carIndex.count(car.getId()))
+        {
+            throw runtime_error("Car ID " + to_string(car.getId()) + " already exists!");
+        }
+        cars.push_back(make_unique<Car>(car));
+        carIndex[car.getId()] = cars.size() - 1;
+        availability.addCar(car.getId(), car.isAvailable());
+        schedules[car.getId()];
+        searchIndex.add(car);
+        columns.append(car);
+        return *cars.back();
+    }
 
-        // Initialize with some sample data if no users exist
-        if (users.empty())
+    // The fleet's own copy of a car; only for use under the table lock
+    Car &carById(int carId)
+    {
+        auto it = carIndex.find(carId);
+        if (it == carIndex.end())
         {
-            users.push_back(make_unique<Admin>(nextUserId++, "admin", "admin123", "admin@carrental.com"));
-            users.push_back(make_unique<Customer>(nextUserId++, "john", "john123", "john@example.com"));
-            users.push_back(make_unique<Customer>(nextUserId++, "alice", "alice123", "alice@example.com"));
-            saveUserData();
+            throw CarNotFoundException();
         }
+        return *cars[it->second];
+    }
 
-        // Only add sample cars if no cars exist
-        if (cars.empty())
+    // Bookings never move, so the pointer stays valid while others are added; it must
+    // still only be used under the table lock, since status changes happen in place
+    Booking *bookingById(int bookingId)
+    {
+        auto it = bookingAt.find(bookingId);
+        return it != bookingAt.end() ? &bookings[it->second] : nullptr;
+    }
+
+    const Booking *bookingById(int bookingId) const
+    {
+        auto it = bookingAt.find(bookingId);
+        return it != bookingAt.end() ? &bookings[it->second] : nullptr;
+    }
+
+    // Needs the write lock. Throws InvalidTransitionException (leaving the booking
+    // untouched) for a disallowed move.
+    void changeBookingStatus(Booking &booking, BookingStatus status)
+    {
+        BookingStatus previous = booking.getStatus();
+        bool held = holdsReservation(previous);
+        booking.setStatus(status);
+        bookingIndex.changeStatus(booking.getId(), previous, status);
+        if (held && !holdsReservation(booking.getStatus()))
         {
-            cars.emplace_back(nextCarId++, "Toyota", "Camry", "Sedan", 2022, "Blue", 50.0, "ABC123");
-            cars.emplace_back(nextCarId++, "Honda", "Civic", "Sedan", 2021, "Red", 45.0, "DEF456");
-            cars.emplace_back(nextCarId++, "Ford", "Explorer", "SUV", 2023, "Black", 70.0, "GHI789");
-            cars.emplace_back(nextCarId++, "Chevrolet", "Silverado", "Truck", 2020, "White", 85.0, "JKL012");
-            saveCarData();
+            releaseDates(booking);
         }
+        bookingStore.update(booking.toRecord());
     }
 
-    void loadUserData()
+    // Bring the derived indexes in step with a car's status or price (no journal)
+    void syncCarStatus(int carId)
     {
-        ifstream inFile(userDataFile);
-        if (!inFile)
+        bool available = carById(carId).isAvailable();
+        availability.setInService(carId, available);
+        columns.setInService(carIndex.at(carId), available);
+    }
+
+    void applyCarPrice(int carId, double price)
+    {
+        carById(carId).setPricePerDay(price);
+        searchIndex.setPrice(carId, price);
+        columns.setPrice(carIndex.at(carId), price);
+    }
+
+    // Re-point the index at every slot from 'first' onwards after an erase
+    void reindexCars(size_t first)
+    {
+        for (size_t slot = first; slot < cars.size(); ++slot)
         {
-            // File doesn't exist yet, that's okay
-            return;
+            carIndex[cars[slot]->getId()] = slot;
         }
-        string line;
-        while (getline(inFile, line))
+    }
+
+    // Bookings in these states hold their car for their dates
+    static bool holdsReservation(BookingStatus status)
+    {
+        return status == BookingStatus::Pending || status == BookingStatus::Approved || status == BookingStatus::Paid;
+    }
+
+    // Claim a booking's dates on its car; false if they clash with another booking.
+    // Only touches that car's schedule (see ScheduleCell), so the shared lock is enough;
+    // the fleet bitmap is marked separately under the write lock.
+    bool reserveDates(const Booking &booking)
+    {
+        if (!holdsReservation(booking.getStatus()))
         {
-            istringstream iss(line);
-            string token;
-            vector<string> tokens;
-            while (getline(iss, token, ','))
-            {
-                tokens.push_back(token);
-            }
-            if (tokens.size() != 5)
-                continue; // Skip invalid lines
-            int id = stoi(tokens[0]);
-            string username = tokens[1];
-            string password = tokens[2];
-            string email = tokens[3];
-            string role = tokens[4];
-            if (role == "admin")
-            {
-                users.push_back(make_unique<Admin>(id, username, password, email));
-            }
-            else
-            {
-                users.push_back(make_unique<Customer>(id, username, password, email));
-            }
-            // Update nextUserId to be higher than any existing ID
-            if (id >= nextUserId)
-            {
-                nextUserId = id + 1;
-            }
+            return true;
         }
+        int start = booking.getStartDate().dayNumber();
+        int end = booking.getEndDate().dayNumber();
+        if (end <= start)
+        {
+            return true; // Empty range (e.g. unreadable dates on disk) blocks nothing
+        }
+        auto it = schedules.find(booking.getCarId());
+        if (it == schedules.end())
+        {
+            return true; // The car is gone, so there is nothing to block
+        }
+        return it->second.claim(start, end, booking.getId());
     }
 
-    void saveUserData()
+    // Keep the bitmap window starting today; days coming into view are filled from the
+    // schedules, and reservations that are over are dropped from them
+    void rollAvailability()
     {
-        ofstream outFile(userDataFile);
-        if (!outFile)
+        int today = Date::today().dayNumber();
+        if (today == availability.horizonStart())
         {
-            cerr << "Error: Could not open user data file for writing!" << endl;
             return;
         }
-        for (const auto &user : users)
+        auto [from, to] = availability.rollTo(today);
+        for (auto &[carId, schedule] : schedules)
         {
-            outFile << user->serialize() << endl;
+            schedule.pruneBefore(today);
+            schedule.forEachOverlapping(from, to, [this, carId = carId](int start, int end)
+                                        { availability.setBusy(carId, start, end, true); });
         }
     }
 
-    void loadCarData()
+    void markBusy(const Booking &booking)
     {
-        ifstream inFile(carDataFile);
-        if (!inFile)
+        if (holdsReservation(booking.getStatus()))
+        {
+            availability.setBusy(booking.getCarId(), booking.getStartDate().dayNumber(),
+                                 booking.getEndDate().dayNumber(), true);
+        }
+    }
+
+    void releaseDates(const Booking &booking)
+    {
+        auto it = schedules.find(booking.getCarId());
+        if (it == schedules.end())
         {
             return;
         }
+        int start = booking.getStartDate().dayNumber();
+        int end = it->second.release(start, booking.getId());
+        availability.setBusy(booking.getCarId(), start, end, false);
+    }
 
-        string line;
-        while (getline(inFile, line))
+    bool eraseCar(int carId)
+    {
+        auto it = carIndex.find(carId);
+        if (it == carIndex.end())
         {
-            istringstream iss(line);
-            string token;
-            vector<string> tokens;
-            while (getline(iss, token, ','))
-            {
-                tokens.push_back(token);
-            }
-            if (tokens.size() >= 8)
-            {
-                int id = stoi(tokens[0]);
-                cars.emplace_back(id, tokens[1], tokens[2], tokens[3],
-                                  stoi(tokens[4]), tokens[5],
-                                  stod(tokens[6]), tokens[7]);
-                if (id >= nextCarId)
-                {
-                    nextCarId = id + 1;
-                }
-            }
+            return false;
         }
+        schedules.erase(carId);
+        availability.removeCar(carId);
+        searchIndex.remove(carId);
+
+        size_t slot = it->second;
+        carIndex.erase(it);
+        cars.erase(cars.begin() + slot);
+        columns.erase(slot);
+        reindexCars(slot);
+        return true;
     }
 
 public:
@@ -773,141 +4214,418 @@ public:
     CarRentalSystem(const CarRentalSystem &) = delete;
     CarRentalSystem &operator=(const CarRentalSystem &) = delete;
 
+    // Write a full snapshot of the fleet now, under the lock, and start a fresh journal.
+    // Routine compaction goes through startCompaction instead.
     void saveCarData()
     {
-        ofstream outFile(carDataFile);
-        if (!outFile)
+        auto guard = tables.write();
+        if (compactor.joinable())
+        {
+            compactor.join(); // both write cars.dat.tmp
+        }
+        if (!writeCarSnapshot(fleetSnapshot()))
         {
-            cerr << "Error: Could not open car data file for writing at: "
-                 << filesystem::absolute(carDataFile).string() << endl;
             return;
         }
 
-        cout << "Saving car data to: " << filesystem::absolute(carDataFile).string() << endl;
+        // The snapshot now covers every journaled mutation
+        error_code ec;
+        filesystem::remove(compactingJournalFile, ec);
+        carJournal.close();
+        carJournal.open(carJournalFile, ios::trunc);
+        carJournalEntries = 0;
+    }
 
-        for (const auto &car : cars)
+    // Let a background cars.dat write finish; call before exiting
+    void waitForCompaction()
+    {
+        auto guard = tables.write();
+        if (compactor.joinable())
         {
-            outFile << car.serialize() << endl;
+            compactor.join();
         }
-
-        cout << "Successfully saved " << cars.size() << " cars to file." << endl;
     }
 
+    // Safe to call from any thread; the first call loads the data exactly once
     static CarRentalSystem *getInstance()
     {
-        if (!instance)
-        {
-            instance = new CarRentalSystem();
-        }
+        static once_flag created;
+        call_once(created, []
+                  { instance = new CarRentalSystem(); });
         return instance;
     }
 
     User *authenticate(const string &username, const string &password)
     {
-        for (const auto &user : users)
+        auto guard = tables.read();
+        auto it = usersByName.find(username);
+        if (it != usersByName.end() && it->second->getPassword() == password)
         {
-            if (user->getUsername() == username && user->getPassword() == password)
-            {
-                return user.get();
-            }
+            return it->second;
         }
         throw AuthenticationException();
     }
 
     void registerUser(const string &username, const string &password, const string &email)
     {
+        auto guard = tables.write();
         // Check if username already exists
-        for (const auto &user : users)
+        if (usersByName.count(username))
         {
-            if (user->getUsername() == username)
-            {
-                throw runtime_error("Username already exists!");
-            }
+            throw runtime_error("Username already exists!");
         }
 
-        users.push_back(make_unique<Customer>(nextUserId++, username, password, email));
+        insertUser(make_unique<Customer>(nextUserId++, username, password, email));
         saveUserData(); // Save the updated user list to file
         cout << "Registration successful! You can now login.\n";
     }
 
     bool removeUser(int userId)
     {
-        auto it = find_if(users.begin(), users.end(),
-                          [userId](const unique_ptr<User> &user)
-                          {
-                              return user->getId() == userId;
-                          });
-
-        if (it != users.end() && (*it)->getRole() != "admin")
+        auto guard = tables.write();
+        User *user = findUserById(userId);
+        if (!user || user->getRole() == "admin")
         {
-            users.erase(it);
-            saveUserData(); // Save the updated user list to file
-            return true;
+            return false;
         }
-        return false;
+
+        usersByName.erase(user->getUsername());
+        usersById.erase(userId);
+        users.erase(find_if(users.begin(), users.end(),
+                            [user](const unique_ptr<User> &u)
+                            { return u.get() == user; }));
+        saveUserData(); // Save the updated user list to file
+        return true;
+    }
+
+    User *findUserById(int userId) const
+    {
+        auto guard = tables.read();
+        auto it = usersById.find(userId);
+        return it != usersById.end() ? it->second : nullptr;
     }
 
     void addCar(const Car &car)
     {
-        cars.push_back(car);
-        saveCarData();
+        auto guard = tables.write();
+        insertCar(car);
+        appendCarJournal("A," + car.serialize());
     }
 
+    // Refuses while any booking still holds the car for its dates
     void removeCar(int carId)
     {
-        auto it = find_if(cars.begin(), cars.end(),
-                          [carId](const Car &car)
-                          { return car.getId() == carId; });
-
-        if (it == cars.end())
+        auto guard = tables.write();
+        for (int bookingId : bookingIndex.ofCar(carId))
+        {
+            const Booking *booking = bookingById(bookingId);
+            if (booking && holdsReservation(booking->getStatus()))
+            {
+                throw runtime_error("Car has active bookings and cannot be removed!");
+            }
+        }
+        if (!eraseCar(carId))
         {
             throw CarNotFoundException();
         }
+        appendCarJournal("R," + to_string(carId));
+    }
 
-        cars.erase(it);
-        saveCarData();
+    // Throws InvalidTransitionException if the car cannot move to that status
+    void updateCarStatus(int carId, CarStatus status)
+    {
+        auto guard = tables.write();
+        carById(carId).setStatus(status);
+        syncCarStatus(carId);
+        appendCarJournal("S," + to_string(carId) + "," + statusName(status));
     }
 
-    Car &getCarById(int carId)
+    void updateCarPrice(int carId, double price)
     {
-        auto it = find_if(cars.begin(), cars.end(),
-                          [carId](const Car &car)
-                          { return car.getId() == carId; });
+        auto guard = tables.write();
+        applyCarPrice(carId, price);
+        appendCarJournal("P," + to_string(carId) + "," + to_string(price));
+    }
 
-        if (it == cars.end())
+    // O(1) lookup. Returns a copy: changes go through updateCarStatus/updateCarPrice,
+    // and the car may be removed as soon as the lock is released.
+    Car getCarById(int carId) const
+    {
+        auto guard = tables.read();
+        auto it = carIndex.find(carId);
+        if (it == carIndex.end())
         {
             throw CarNotFoundException();
         }
 
-        return *it;
+        return *cars[it->second];
+    }
+
+    bool hasRegistration(const string &registrationNumber) const
+    {
+        auto guard = tables.read();
+        return any_of(cars.begin(), cars.end(), [&registrationNumber](const unique_ptr<Car> &car)
+                      { return car->getRegistrationNumber() == registrationNumber; });
+    }
+
+    // True if the car is in service and no active booking overlaps [startDay, endDay)
+    bool isCarFree(int carId, int startDay, int endDay) const
+    {
+        auto guard = tables.read();
+        auto slot = carIndex.find(carId);
+        if (slot == carIndex.end() || !cars[slot->second]->isAvailable())
+        {
+            return false;
+        }
+        auto schedule = schedules.find(carId);
+        return schedule == schedules.end() || schedule->second.isFree(startDay, endDay);
     }
 
-    const vector<Car> &getAllCars() const
+    // Calls fn(const Car &) for every in-service car, without copying or allocating
+    template <typename Fn>
+    void forEachAvailableCar(Fn fn) const
     {
-        return cars;
+        auto guard = tables.read();
+        for (size_t slot = 0; slot < columns.size(); ++slot)
+        {
+            if (columns.isInService(slot))
+            {
+                fn(*cars[slot]);
+            }
+        }
     }
 
-    vector<Car> getAllAvailableCars() const
+    // One page of the in-service cars matching the query, copied out of the fleet.
+    // Selective criteria are answered from the indexes and broad ones (where the best index
+    // would still return over 1/scanRatio of the fleet) by a column scan. The date window
+    // is then checked per candidate against its schedule, or drives the search from the
+    // bitmap (within its horizon) if nothing else was given. Only the requested page is
+    // ordered (partial sort).
+    CarPage findCars(const CarQuery &query) const
     {
-        vector<Car> availableCars;
-        copy_if(cars.begin(), cars.end(), back_inserter(availableCars),
-                [](const Car &car)
-                { return car.isAvailable(); });
-        return availableCars;
+        auto guard = tables.read();
+        vector<int> carIds;
+        bool byId = searchIndex.candidates(query, carIds, cars.size() / scanRatio);
+        if (!byId && query.hasWindow() && !query.hasFilters() &&
+            availability.covers(query.startDay, query.endDay))
+        {
+            carIds = availability.freeCars(query.startDay, query.endDay);
+            byId = true;
+        }
+
+        vector<const Car *> matches;
+        if (!byId && !query.hasFilters())
+        {
+            // No filters, and a window (if any) beyond the bitmap: check each schedule
+            matches.reserve(cars.size());
+            forEachAvailableCar([&](const Car &car)
+                                {
+                                    if (!query.hasWindow() || isCarFree(car.getId(), query.startDay, query.endDay))
+                                    {
+                                        matches.push_back(&car);
+                                    } });
+        }
+        else if (!byId)
+        {
+            columns.scan(query, [&](size_t slot)
+                         {
+                             const Car &car = *cars[slot];
+                             if (!query.hasWindow() || isCarFree(car.getId(), query.startDay, query.endDay))
+                             {
+                                 matches.push_back(&car);
+                             } });
+        }
+        else
+        {
+            matches.reserve(carIds.size());
+            for (int carId : carIds)
+            {
+                const Car &car = *cars[carIndex.at(carId)];
+                if (!car.isAvailable() || (query.hasWindow() && !isCarFree(carId, query.startDay, query.endDay)))
+                {
+                    continue;
+                }
+                matches.push_back(&car);
+            }
+        }
+
+        auto before = [sortBy = query.sortBy](const Car *a, const Car *b)
+        {
+            if (sortBy == CarQuery::SortBy::Price && a->getPricePerDay() != b->getPricePerDay())
+            {
+                return a->getPricePerDay() < b->getPricePerDay();
+            }
+            if (sortBy == CarQuery::SortBy::Year && a->getYear() != b->getYear())
+            {
+                return a->getYear() > b->getYear();
+            }
+            return a->getId() < b->getId();
+        };
+        CarPage page;
+        page.total = matches.size();
+        size_t first = min(query.offset, matches.size());
+        size_t last = query.limit ? min(matches.size(), first + query.limit) : matches.size();
+        partial_sort(matches.begin(), matches.begin() + last, matches.end(), before);
+        page.cars.reserve(last - first);
+        for (size_t i = first; i < last; ++i)
+        {
+            page.cars.push_back(*matches[i]);
+        }
+        return page;
     }
 
+    // Unique across restarts; safe to call from any thread
+    int newBookingId() { return bookingIds.next(); }
+    int newPaymentId() { return paymentIds.next(); }
+
+    // Throws if the car is gone, out of service or already booked for any of the requested
+    // days. The dates are claimed under the shared lock, so bookings for different cars go
+    // ahead in parallel and only the short append to the tables is serialized.
     void addBooking(const Booking &booking)
     {
+        if (booking.getStartDate() < Date::today())
+        {
+            throw runtime_error("Bookings cannot start in the past!"); // Schedules drop past days
+        }
+        {
+            auto guard = tables.read();
+            if (!carById(booking.getCarId()).isAvailable())
+            {
+                throw runtime_error("Car is not available for booking!");
+            }
+            if (!reserveDates(booking))
+            {
+                throw runtime_error("Car is already booked for those dates!");
+            }
+        }
+        auto guard = tables.write();
+        if (!carIndex.count(booking.getCarId()))
+        {
+            throw CarNotFoundException(); // Removed while the dates were being claimed
+        }
+        rollAvailability();
+        markBusy(booking);
+        bookingAt[booking.getId()] = bookings.size();
         bookings.push_back(booking);
+        bookingIndex.add(booking);
+        bookingStore.append(booking.toRecord());
+    }
+
+    // A snapshot of the booking; its status may change once the lock is released
+    optional<Booking> findBookingById(int bookingId) const
+    {
+        auto guard = tables.read();
+        const Booking *booking = bookingById(bookingId);
+        return booking ? optional<Booking>(*booking) : nullopt;
+    }
+
+    // Visits the listed bookings in order
+    template <typename Fn>
+    void forEachBooking(const vector<int> &bookingIds, Fn fn) const
+    {
+        auto guard = tables.read();
+        for (int bookingId : bookingIds)
+        {
+            if (const Booking *booking = bookingById(bookingId))
+            {
+                fn(*booking);
+            }
+        }
+    }
+
+    // Visits one user's bookings, oldest first, without touching anyone else's
+    template <typename Fn>
+    void forEachUserBooking(int userId, Fn fn) const
+    {
+        auto guard = tables.read();
+        forEachBooking(bookingIndex.ofUser(userId), fn);
+    }
+
+    // Visits the bookings in one status, oldest first (e.g. the approval queue)
+    template <typename Fn>
+    void forEachBookingWithStatus(BookingStatus status, Fn fn) const
+    {
+        auto guard = tables.read();
+        forEachBooking(bookingIndex.withStatus(status), fn);
+    }
+
+    // One user's bookings in one status, walking whichever of the two lists is shorter
+    template <typename Fn>
+    void forEachUserBookingWithStatus(int userId, BookingStatus status, Fn fn) const
+    {
+        auto guard = tables.read();
+        const vector<int> &mine = bookingIndex.ofUser(userId);
+        const vector<int> &inStatus = bookingIndex.withStatus(status);
+        forEachBooking(mine.size() <= inStatus.size() ? mine : inStatus,
+                       [userId, status, &fn](const Booking &booking)
+                       {
+                           if (booking.getUserId() == userId && booking.getStatus() == status)
+                           {
+                               fn(booking);
+                           }
+                       });
+    }
+
+    size_t countUserBookings(int userId) const
+    {
+        auto guard = tables.read();
+        return bookingIndex.ofUser(userId).size();
+    }
+
+    size_t countBookingsWithStatus(BookingStatus status) const
+    {
+        auto guard = tables.read();
+        return bookingIndex.withStatus(status).size();
+    }
+
+    optional<Payment> findPaymentForBooking(int bookingId) const
+    {
+        auto guard = tables.read();
+        auto it = paymentAt.find(bookingIndex.paymentFor(bookingId));
+        return it != paymentAt.end() ? optional<Payment>(payments[it->second]) : nullopt;
+    }
+
+    // Moves the booking on and returns it as updated. The move is checked against the
+    // booking's current status under the write lock, whatever the caller saw earlier.
+    // Throws BookingNotFoundException, or InvalidTransitionException (leaving the booking
+    // untouched) for a disallowed move.
+    Booking updateBookingStatus(int bookingId, BookingStatus status)
+    {
+        auto guard = tables.write();
+        Booking *booking = bookingById(bookingId);
+        if (!booking)
+        {
+            throw BookingNotFoundException();
+        }
+        changeBookingStatus(*booking, status);
+        return *booking;
     }
 
-    vector<Booking> &getAllBookings()
+    // Records the payment and moves its booking on to Paid. The booking must be Approved
+    // and unpaid, checked under the same lock as the append so two payments cannot race;
+    // otherwise throws InvalidTransitionException and records nothing.
+    void addPayment(const Payment &payment)
     {
-        return bookings;
+        auto guard = tables.write();
+        Booking *booking = bookingById(payment.getBookingId());
+        if (!booking)
+        {
+            throw BookingNotFoundException();
+        }
+        if (booking->getStatus() != BookingStatus::Approved || bookingIndex.paymentFor(booking->getId()) != -1)
+        {
+            throw InvalidTransitionException(statusName(booking->getStatus()), statusName(BookingStatus::Paid));
+        }
+        paymentAt[payment.getId()] = payments.size();
+        payments.push_back(payment);
+        bookingIndex.addPayment(payment.getBookingId(), payment.getId());
+        paymentStore.append(payment.toRecord());
+        changeBookingStatus(*booking, BookingStatus::Paid);
     }
 
     void viewAllCars() const
     {
+        auto guard = tables.read();
         if (cars.empty())
         {
             cout << "No cars in the system.\n";
@@ -916,13 +4634,14 @@ public:
 
         for (const auto &car : cars)
         {
-            car.display();
+            car->display();
             cout << "------------------------\n";
         }
     }
 
     void viewAllBookings() const
     {
+        auto guard = tables.read();
         if (bookings.empty())
         {
             cout << "No bookings in the system.\n";
@@ -936,15 +4655,22 @@ public:
         }
     }
 
-    const vector<unique_ptr<User>> &getUsers() const
+    // Calls fn(const User &) for every user, in registration order
+    template <typename Fn>
+    void forEachUser(Fn fn) const
     {
-        return users;
+        auto guard = tables.read();
+        for (const auto &user : users)
+        {
+            fn(*user);
+        }
     }
 
     void run();
 
     int getNextCarId()
     {
+        auto guard = tables.write();
         return nextCarId++;
     }
 
@@ -956,12 +4682,17 @@ private:
 // Initialize static member
 CarRentalSystem *CarRentalSystem::instance = nullptr;
 
+// Tests and benchmarks include this file with CAR_RENTAL_NO_MAIN and bring their own main
+#ifndef CAR_RENTAL_NO_MAIN
 int main()
 {
     CarRentalSystem *system = CarRentalSystem::getInstance();
     system->run();
+    system->waitForCompaction();
+    Logger::getInstance()->shutdown(); // Flush buffered log entries before exit
     return 0;
 }
+#endif
 
 void Admin::displayMenu()
 {
@@ -1247,16 +4978,7 @@ void Admin::addCar(CarRentalSystem &system)
         }
 
         // Check if registration number already exists
-        bool exists = false;
-        for (const auto &car : system.getAllCars())
-        {
-            if (car.getRegistrationNumber() == regNum)
-            {
-                exists = true;
-                break;
-            }
-        }
-        if (exists)
+        if (system.hasRegistration(regNum))
         {
             cout << "Error: Registration number already exists!\n";
             continue;
@@ -1326,7 +5048,7 @@ void Admin::updateCar(CarRentalSystem &system)
 
     try
     {
-        Car &car = system.getCarById(carId);
+        Car car = system.getCarById(carId);
         car.display();
 
         cout << "Select field to update:\n";
@@ -1346,18 +5068,32 @@ void Admin::updateCar(CarRentalSystem &system)
             double newPrice;
             cin >> newPrice;
             cin.ignore();
-            car.setPricePerDay(newPrice);
+            system.updateCarPrice(carId, newPrice);
             cout << "Price updated successfully.\n";
             break;
         }
         case 2:
         {
-            cout << "Set availability (1 for Available, 0 for Rented): ";
-            bool available;
-            cin >> available;
+            cout << "Set availability (1 for Available, 0 for Rented, 2 for Maintenance): ";
+            int available;
+            if (!(cin >> available) || available < 0 || available > 2)
+            {
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Invalid choice.\n";
+                break;
+            }
             cin.ignore();
-            car.setAvailable(available);
-            cout << "Availability updated successfully.\n";
+            constexpr CarStatus choices[] = {CarStatus::Rented, CarStatus::Available, CarStatus::Maintenance};
+            try
+            {
+                system.updateCarStatus(carId, choices[available]);
+                cout << "Availability updated successfully.\n";
+            }
+            catch (const InvalidTransitionException &e)
+            {
+                cout << "Error: " << e.what() << endl;
+            }
             break;
         }
         default:
@@ -1385,7 +5121,7 @@ void Admin::removeCar(CarRentalSystem &system)
         system.removeCar(carId);
         cout << "Car removed successfully.\n";
     }
-    catch (const CarNotFoundException &e)
+    catch (const exception &e)
     {
         cout << "Error: " << e.what() << endl;
     }
@@ -1408,6 +5144,7 @@ void Admin::manageBookings(CarRentalSystem &system)
         cout << "2. View Pending Bookings\n";
         cout << "3. Approve/Reject Booking\n";
         cout << "4. View Booking History\n";
+        cout << "5. Mark Booking Returned\n";
         cout << "0. Back to Main Menu\n";
         cout << "Enter your choice: ";
 
@@ -1427,26 +5164,21 @@ void Admin::manageBookings(CarRentalSystem &system)
         {
             cout << "\n--- Pending Bookings ---\n";
             cout << "=======================\n";
-            bool found = false;
-            for (const auto &booking : system.getAllBookings())
-            {
-                if (booking.getStatus() == "Pending")
-                {
-                    found = true;
-                    booking.display();
-                    try
-                    {
-                        Car &car = system.getCarById(booking.getCarId());
-                        cout << "Car Details: " << car.getBrand() << " " << car.getModel()
-                             << " (" << car.getRegistrationNumber() << ")\n";
-                    }
-                    catch (...)
-                    {
-                        cout << "Car Details: Not found\n";
-                    }
-                    cout << "------------------------\n";
-                }
-            }
+            bool found = system.countBookingsWithStatus(BookingStatus::Pending) > 0;
+            system.forEachBookingWithStatus(BookingStatus::Pending, [&system](const Booking &booking)
+                                            {
+                                                booking.display();
+                                                try
+                                                {
+                                                    Car car = system.getCarById(booking.getCarId());
+                                                    cout << "Car Details: " << car.getBrand() << " " << car.getModel()
+                                                         << " (" << car.getRegistrationNumber() << ")\n";
+                                                }
+                                                catch (...)
+                                                {
+                                                    cout << "Car Details: Not found\n";
+                                                }
+                                                cout << "------------------------\n"; });
             if (!found)
             {
                 cout << "No pending bookings found.\n";
@@ -1459,26 +5191,21 @@ void Admin::manageBookings(CarRentalSystem &system)
             cout << "============================\n";
 
             // Show only pending bookings
-            bool found = false;
-            for (const auto &booking : system.getAllBookings())
-            {
-                if (booking.getStatus() == "Pending")
-                {
-                    found = true;
-                    booking.display();
-                    try
-                    {
-                        Car &car = system.getCarById(booking.getCarId());
-                        cout << "Car Details: " << car.getBrand() << " " << car.getModel()
-                             << " (" << car.getRegistrationNumber() << ")\n";
-                    }
-                    catch (...)
-                    {
-                        cout << "Car Details: Not found\n";
-                    }
-                    cout << "------------------------\n";
-                }
-            }
+            bool found = system.countBookingsWithStatus(BookingStatus::Pending) > 0;
+            system.forEachBookingWithStatus(BookingStatus::Pending, [&system](const Booking &booking)
+                                            {
+                                                booking.display();
+                                                try
+                                                {
+                                                    Car car = system.getCarById(booking.getCarId());
+                                                    cout << "Car Details: " << car.getBrand() << " " << car.getModel()
+                                                         << " (" << car.getRegistrationNumber() << ")\n";
+                                                }
+                                                catch (...)
+                                                {
+                                                    cout << "Car Details: Not found\n";
+                                                }
+                                                cout << "------------------------\n"; });
 
             if (!found)
             {
@@ -1497,14 +5224,11 @@ void Admin::manageBookings(CarRentalSystem &system)
                 break;
             }
 
-            vector<Booking> &bookings = system.getAllBookings();
-            auto it = find_if(bookings.begin(), bookings.end(),
-                              [bookingId](const Booking &b)
-                              { return b.getId() == bookingId; });
+            optional<Booking> it = system.findBookingById(bookingId);
 
-            if (it != bookings.end())
+            if (it)
             {
-                if (it->getStatus() != "Pending")
+                if (it->getStatus() != BookingStatus::Pending)
                 {
                     cout << "\nThis booking has already been processed (Current status: "
                          << it->getStatus() << ")\n";
@@ -1517,7 +5241,7 @@ void Admin::manageBookings(CarRentalSystem &system)
 
                 try
                 {
-                    Car &car = system.getCarById(it->getCarId());
+                    Car car = system.getCarById(it->getCarId());
                     cout << "Car Details: " << car.getBrand() << " " << car.getModel()
                          << " (" << car.getRegistrationNumber() << ")\n";
                     cout << "Current Car Status: " << car.getStatus() << "\n";
@@ -1545,36 +5269,23 @@ void Admin::manageBookings(CarRentalSystem &system)
                     break;
                 }
 
-                string status = (action == 1) ? "Approved" : "Rejected";
-                it->setStatus(status);
-
-                try
-                {
-                    Car &car = system.getCarById(it->getCarId());
-                    if (status == "Approved")
-                    {
-                        car.setStatus("Rented");
-                    }
-                    else
-                    {
-                        car.setStatus("Available");
-                    }
+                BookingStatus status = (action == 1) ? BookingStatus::Approved : BookingStatus::Rejected;
+                try
+                {
+                    // Fails if the customer cancelled (or another admin decided) meanwhile
+                    *it = system.updateBookingStatus(bookingId, status);
+                    Car car = system.getCarById(it->getCarId());
 
                     // Find the customer username
                     string username = "Unknown";
                     string email = "";
-                    for (const auto &user : system.getUsers())
+                    if (User *user = system.findUserById(it->getUserId()))
                     {
-                        if (user->getId() == it->getUserId())
-                        {
-                            username = user->getUsername();
-                            email = user->getEmail();
-                            break;
-                        }
+                        username = user->getUsername();
+                        email = user->getEmail();
                     }
 
-                    Logger::getInstance()->logBookingUpdate(username, status, *it, car);
-                    system.saveCarData();
+                    Logger::getInstance()->logBookingUpdate(username, statusName(status), *it, car);
 
                     cout << "\nBooking " << status << " successfully!\n";
                     cout << "\nUpdated Booking Details:\n";
@@ -1597,13 +5308,37 @@ void Admin::manageBookings(CarRentalSystem &system)
         {
             cout << "\n--- Booking History ---\n";
             cout << "=====================\n";
-            auto logs = Logger::getInstance()->readLogs();
-            for (const auto &log : logs)
+            Logger::getInstance()->forEachBookingUpdate([](const BookingEvent &event)
+                                                        { cout << event.render(); });
+            break;
+        }
+        case 5:
+        {
+            cout << "\n--- Mark Booking Returned ---\n";
+            cout << "Enter Booking ID (0 to cancel): ";
+            int bookingId;
+            cin >> bookingId;
+            cin.ignore();
+
+            if (bookingId == 0)
             {
-                if (log.find("=== BOOKING UPDATE ===") != string::npos)
-                {
-                    cout << log << endl;
-                }
+                cout << "Operation cancelled.\n";
+                break;
+            }
+
+            try
+            {
+                // Frees the car for any days left in the booking
+                Booking booking = system.updateBookingStatus(bookingId, BookingStatus::Returned);
+                Car car = system.getCarById(booking.getCarId());
+                User *user = system.findUserById(booking.getUserId());
+                Logger::getInstance()->logBookingUpdate(user ? user->getUsername() : "Unknown",
+                                                        statusName(BookingStatus::Returned), booking, car);
+                cout << "Booking " << bookingId << " marked as returned.\n";
+            }
+            catch (const exception &e)
+            {
+                cout << "Error: " << e.what() << endl;
             }
             break;
         }
@@ -1629,68 +5364,26 @@ void Admin::viewPaymentRecords() const
     cin >> choice;
     cin.ignore();
 
-    auto logs = Logger::getInstance()->readLogs();
-    double totalRevenue = 0.0;
-    map<string, double> revenueByMethod;
-
     switch (choice)
     {
     case 1:
     {
         cout << "\n=== Transaction History ===\n";
-        for (const auto &log : logs)
-        {
-            cout << log << endl;
-        }
+        Logger::getInstance()->forEachTransaction([](const TransactionEvent &transaction)
+                                                  { cout << transaction.render(); });
         break;
     }
     case 2:
     {
         cout << "\n=== Revenue Report ===\n";
-        for (const auto &log : logs)
-        {
-            if (log.find("Revenue Generated: $") != string::npos)
-            {
-                size_t pos = log.find("$");
-                if (pos != string::npos)
-                {
-                    try
-                    {
-                        double amount = stod(log.substr(pos + 1));
-                        totalRevenue += amount;
-                    }
-                    catch (...)
-                    {
-                        // Skip invalid amounts
-                    }
-                }
-            }
-            if (log.find("Method: ") != string::npos)
-            {
-                size_t methodPos = log.find("Method: ") + 8;
-                size_t amountPos = log.find("$");
-                if (methodPos != string::npos && amountPos != string::npos)
-                {
-                    string method = log.substr(methodPos, log.find("\n", methodPos) - methodPos);
-                    try
-                    {
-                        double amount = stod(log.substr(amountPos + 1));
-                        revenueByMethod[method] += amount;
-                    }
-                    catch (...)
-                    {
-                        // Skip invalid amounts
-                    }
-                }
-            }
-        }
+        ReportAggregates totals = Logger::getInstance()->getReportAggregates();
 
-        cout << "Total Revenue: $" << fixed << setprecision(2) << totalRevenue << "\n\n";
+        cout << "Total Revenue: $" << fixed << setprecision(2) << totals.totalRevenue << "\n\n";
         cout << "Revenue by Payment Method:\n";
-        for (const auto &[method, amount] : revenueByMethod)
+        for (const auto &[method, group] : totals.byMethod)
         {
-            cout << method << ": $" << fixed << setprecision(2) << amount
-                 << " (" << (amount / totalRevenue * 100) << "%)\n";
+            cout << method << ": $" << fixed << setprecision(2) << group.amount
+                 << " (" << (group.amount / totals.totalRevenue * 100) << "%)\n";
         }
         break;
     }
@@ -1721,13 +5414,11 @@ void Admin::manageUsers(CarRentalSystem &system)
         case 1:
         {
             cout << "\n--- All Users ---\n";
-            for (const auto &user : system.getUsers())
-            {
-                cout << "ID: " << user->getId()
-                     << " | Username: " << user->getUsername()
-                     << " | Email: " << user->getEmail()
-                     << " | Role: " << user->getRole() << endl;
-            }
+            system.forEachUser([](const User &user)
+                               { cout << "ID: " << user.getId()
+                                      << " | Username: " << user.getUsername()
+                                      << " | Email: " << user.getEmail()
+                                      << " | Role: " << user.getRole() << endl; });
             break;
         }
         case 2:
@@ -1738,17 +5429,18 @@ void Admin::manageUsers(CarRentalSystem &system)
             getline(cin, username);
 
             cout << "\nActivity for user '" << username << "':\n";
-            auto logs = Logger::getInstance()->readLogs();
+            Logger *logger = Logger::getInstance();
             bool found = false;
-            for (const auto &log : logs)
+            auto showIfMine = [&username, &found](const auto &event)
             {
-                if (log.find("Username: " + username) != string::npos ||
-                    log.find("Customer: " + username) != string::npos)
+                if (event.username == username)
                 {
-                    cout << log << endl;
+                    cout << event.render();
                     found = true;
                 }
-            }
+            };
+            logger->forEachTransaction(showIfMine);
+            logger->forEachBookingLogEvent(showIfMine, showIfMine);
             if (!found)
             {
                 cout << "No activity found for this user.\n";
@@ -1759,16 +5451,15 @@ void Admin::manageUsers(CarRentalSystem &system)
         {
             cout << "\n--- Remove User ---\n";
             cout << "Current Users:\n";
-            for (const auto &user : system.getUsers())
-            {
-                if (user->getRole() != "admin")
-                { // Don't show admins in the removal list
-                    cout << "ID: " << user->getId()
-                         << " | Username: " << user->getUsername()
-                         << " | Email: " << user->getEmail()
-                         << " | Role: " << user->getRole() << endl;
-                }
-            }
+            system.forEachUser([](const User &user)
+                               {
+                                   if (user.getRole() != "admin")
+                                   { // Don't show admins in the removal list
+                                       cout << "ID: " << user.getId()
+                                            << " | Username: " << user.getUsername()
+                                            << " | Email: " << user.getEmail()
+                                            << " | Role: " << user.getRole() << endl;
+                                   } });
 
             cout << "\nEnter User ID to remove (0 to cancel): ";
             int userId;
@@ -1807,12 +5498,13 @@ void Admin::generateReports() const
     cout << "2. Booking Statistics\n";
     cout << "3. Popular Cars Report\n";
     cout << "4. Customer Activity Report\n";
+    cout << "5. Rebuild Report Totals from Logs\n";
     cout << "Enter choice: ";
 
     cin >> choice;
     cin.ignore();
 
-    auto logs = Logger::getInstance()->readLogs();
+    ReportAggregates totals = Logger::getInstance()->getReportAggregates();
 
     switch (choice)
     {
@@ -1825,117 +5517,53 @@ void Admin::generateReports() const
     case 2:
     {
         cout << "\n=== Booking Statistics ===\n";
-        map<string, int> bookingsByStatus;
-        map<string, int> bookingsByMonth;
-
-        for (const auto &log : logs)
-        {
-            if (log.find("Status: ") != string::npos)
-            {
-                size_t pos = log.find("Status: ") + 8;
-                string status = log.substr(pos, log.find("\n", pos) - pos);
-                bookingsByStatus[status]++;
-            }
-            if (log.find("Start Date: ") != string::npos)
-            {
-                size_t pos = log.find("Start Date: ") + 12;
-                string date = log.substr(pos, 7); // YYYY-MM
-                bookingsByMonth[date]++;
-            }
-        }
 
         cout << "Bookings by Status:\n";
-        for (const auto &[status, count] : bookingsByStatus)
+        for (const auto &[status, group] : totals.byStatus)
         {
-            cout << status << ": " << count << endl;
+            cout << status << ": " << group.count << endl;
         }
 
         cout << "\nBookings by Month:\n";
-        for (const auto &[month, count] : bookingsByMonth)
+        for (const auto &[month, group] : totals.byMonth)
         {
-            cout << month << ": " << count << endl;
+            cout << month << ": " << group.count << endl;
         }
         break;
     }
     case 3:
     {
         cout << "\n=== Popular Cars Report ===\n";
-        map<string, int> carBookings;
-        map<string, double> carRevenue;
-
-        for (const auto &log : logs)
-        {
-            if (log.find("Brand: ") != string::npos)
-            {
-                size_t brandPos = log.find("Brand: ") + 7;
-                string car = log.substr(brandPos, log.find("\n", brandPos) - brandPos);
-                carBookings[car]++;
-
-                size_t revenuePos = log.find("Revenue Generated: $");
-                if (revenuePos != string::npos)
-                {
-                    try
-                    {
-                        double amount = stod(log.substr(revenuePos + 19));
-                        carRevenue[car] += amount;
-                    }
-                    catch (...)
-                    {
-                        // Skip invalid amounts
-                    }
-                }
-            }
-        }
 
         cout << "Car Booking Frequency:\n";
-        for (const auto &[car, count] : carBookings)
+        for (const auto &[car, group] : totals.byCar)
         {
             cout << car << ":\n";
-            cout << "  Bookings: " << count << "\n";
-            cout << "  Revenue: $" << fixed << setprecision(2) << carRevenue[car] << "\n";
+            cout << "  Bookings: " << group.count << "\n";
+            cout << "  Revenue: $" << fixed << setprecision(2) << group.amount << "\n";
         }
         break;
     }
     case 4:
     {
         cout << "\n=== Customer Activity Report ===\n";
-        map<string, int> customerBookings;
-        map<string, double> customerSpending;
-
-        for (const auto &log : logs)
-        {
-            if (log.find("Username: ") != string::npos)
-            {
-                size_t userPos = log.find("Username: ") + 10;
-                string username = log.substr(userPos, log.find("\n", userPos) - userPos);
-                customerBookings[username]++;
-
-                size_t amountPos = log.find("Amount: $");
-                if (amountPos != string::npos)
-                {
-                    try
-                    {
-                        double amount = stod(log.substr(amountPos + 9));
-                        customerSpending[username] += amount;
-                    }
-                    catch (...)
-                    {
-                        // Skip invalid amounts
-                    }
-                }
-            }
-        }
 
         cout << "Customer Activity:\n";
-        for (const auto &[username, count] : customerBookings)
+        for (const auto &[username, group] : totals.byCustomer)
         {
             cout << "Customer: " << username << "\n";
-            cout << "  Total Bookings: " << count << "\n";
-            cout << "  Total Spending: $" << fixed << setprecision(2)
-                 << customerSpending[username] << "\n";
+            cout << "  Total Bookings: " << group.count << "\n";
+            cout << "  Total Spending: $" << fixed << setprecision(2) << group.amount << "\n";
         }
         break;
     }
+    case 5:
+    {
+        cout << "\n=== Rebuild Report Totals ===\n";
+        Logger::getInstance()->rebuildReportAggregates();
+        cout << "Report totals rebuilt from the logs.\n";
+        break;
+    }
     default:
         cout << "Invalid choice!\n";
         break;
@@ -2164,118 +5792,222 @@ void Customer::searchCars(const CarRentalSystem &system) const
     cout << "2. By Type\n";
     cout << "3. By Price Range\n";
     cout << "4. Show All Available Cars\n";
+    cout << "5. Available Between Dates\n";
+    cout << "6. Combined Search\n";
+    cout << "7. Keyword (Brand, Model or Registration)\n";
     cout << "Enter your choice: ";
 
     int choice;
     cin >> choice;
     cin.ignore();
 
-    vector<Car> availableCars = system.getAllAvailableCars();
-
-    if (availableCars.empty())
+    auto ask = [](const string &prompt)
     {
-        cout << "No available cars found.\n";
-        return;
-    }
-
-    vector<Car> filteredCars;
+        cout << prompt;
+        string line;
+        getline(cin, line);
+        return line;
+    };
+    // Blank input leaves the value unchanged; false if the text is not a number
+    auto askNumber = [&ask](const string &prompt, auto &value)
+    {
+        string line = ask(prompt);
+        return line.empty() || parseNumber(line, value);
+    };
 
+    CarQuery query;
+    string heading = "car(s):";
+    string emptyMessage = "No cars match your criteria.\n";
     switch (choice)
     {
     case 1:
-    {
-        cout << "Enter brand name (or part of it): ";
-        string brand;
-        getline(cin, brand);
-        transform(brand.begin(), brand.end(), brand.begin(), ::tolower);
-
-        copy_if(availableCars.begin(), availableCars.end(), back_inserter(filteredCars),
-                [&brand](const Car &car)
-                {
-                    string carBrand = car.getBrand();
-                    transform(carBrand.begin(), carBrand.end(), carBrand.begin(), ::tolower);
-                    return carBrand.find(brand) != string::npos;
-                });
+        query.brand = ask("Enter brand name (or part of it): ");
         break;
-    }
     case 2:
-    {
-        cout << "Enter type (Sedan/SUV/Truck): ";
-        string type;
-        getline(cin, type);
-        transform(type.begin(), type.end(), type.begin(), ::tolower);
-
-        copy_if(availableCars.begin(), availableCars.end(), back_inserter(filteredCars),
-                [&type](const Car &car)
-                {
-                    string carType = car.getType();
-                    transform(carType.begin(), carType.end(), carType.begin(), ::tolower);
-                    return carType.find(type) != string::npos;
-                });
+        query.type = ask("Enter type (Sedan/SUV/Truck): ");
         break;
-    }
     case 3:
-    {
         cout << "Enter minimum price: ";
-        double minPrice;
-        cin >> minPrice;
+        cin >> query.minPrice;
         cout << "Enter maximum price: ";
-        double maxPrice;
-        cin >> maxPrice;
+        cin >> query.maxPrice;
         cin.ignore();
-
-        copy_if(availableCars.begin(), availableCars.end(), back_inserter(filteredCars),
-                [minPrice, maxPrice](const Car &car)
-                {
-                    return car.getPricePerDay() >= minPrice && car.getPricePerDay() <= maxPrice;
-                });
         break;
-    }
     case 4:
-        filteredCars = availableCars;
         break;
+    case 7:
+        query.keyword = ask("Enter keyword: ");
+        break;
+    case 5:
+    case 6:
+    {
+        if (choice == 6)
+        {
+            query.brand = ask("Brand contains (or press Enter for any): ");
+            query.type = ask("Type contains (or press Enter for any): ");
+            query.color = ask("Color contains (or press Enter for any): ");
+            if (!askNumber("Minimum price (or press Enter for any): ", query.minPrice) ||
+                !askNumber("Maximum price (or press Enter for any): ", query.maxPrice) ||
+                !askNumber("Oldest year (or press Enter for any): ", query.minYear) ||
+                !askNumber("Newest year (or press Enter for any): ", query.maxYear))
+            {
+                cout << "Invalid number.\n";
+                return;
+            }
+        }
+
+        string prompt = choice == 5 ? "Enter start date (YYYY-MM-DD): " : "Start date (YYYY-MM-DD, or press Enter for any): ";
+        string startDate = ask(prompt);
+        string endDate = startDate.empty() && choice == 6 ? "" : ask("Enter end date (YYYY-MM-DD): ");
+        if (!startDate.empty() || choice == 5)
+        {
+            try
+            {
+                query.startDay = Date::parse(startDate).dayNumber();
+                query.endDay = Date::parse(endDate).dayNumber();
+            }
+            catch (const runtime_error &e)
+            {
+                cout << e.what() << endl;
+                return;
+            }
+            if (query.endDay <= query.startDay)
+            {
+                cout << "Error: End date must be after start date.\n";
+                return;
+            }
+            heading = "car(s) free from " + startDate + " to " + endDate + ":";
+            emptyMessage = "No cars are free for those dates.\n";
+        }
+
+        if (choice == 5)
+        {
+            query.brand = ask("Brand contains (or press Enter for any): ");
+            query.type = ask("Type contains (or press Enter for any): ");
+            break;
+        }
+
+        string order = ask("Sort by: 1. Car ID  2. Lowest price  3. Newest year (Enter for 1): ");
+        query.sortBy = order == "2" ? CarQuery::SortBy::Price : order == "3" ? CarQuery::SortBy::Year : CarQuery::SortBy::Id;
+        query.limit = 10;
+        if (!askNumber("Results per page (or press Enter for 10): ", query.limit))
+        {
+            cout << "Invalid number.\n";
+            return;
+        }
+        break;
+    }
     default:
         cout << "Invalid choice. Showing all available cars.\n";
-        filteredCars = availableCars;
     }
 
-    if (filteredCars.empty())
-    {
-        cout << "No cars match your criteria.\n";
-    }
-    else
+    // Each page is a snapshot of the fleet; only the requested page is sorted
+    while (true)
     {
-        cout << "\nFound " << filteredCars.size() << " car(s):\n";
-        cout << "========================================\n";
-        for (const auto &car : filteredCars)
+        CarPage page = system.findCars(query);
+        if (page.total == 0 && !query.fuzzy && (!query.brand.empty() || !query.keyword.empty()))
+        {
+            // Nothing contains the text as typed; allow for a typo or two
+            query.fuzzy = true;
+            page = system.findCars(query);
+            if (page.total > 0)
+            {
+                cout << "No exact matches. Showing close matches instead.\n";
+            }
+        }
+        if (page.total == 0)
+        {
+            cout << emptyMessage;
+            return;
+        }
+        if (query.offset == 0)
+        {
+            cout << "\nFound " << page.total << " " << heading << "\n";
+            cout << "========================================\n";
+        }
+        for (const Car &car : page.cars)
         {
             car.display();
             cout << "----------------------------------------\n";
         }
+
+        size_t shown = query.offset + page.cars.size();
+        if (query.limit == 0 || shown >= page.total)
+        {
+            return;
+        }
+        string more = ask("Showing " + to_string(query.offset + 1) + "-" + to_string(shown) + " of " +
+                          to_string(page.total) + ". Press Enter for more or 'q' to stop: ");
+        if (more == "q" || more == "Q")
+        {
+            return;
+        }
+        query.offset += query.limit;
     }
 }
 
 void Customer::bookCar(CarRentalSystem &system)
 {
     cout << "\n--- Book a Car ---\n";
-    vector<Car> availableCars = system.getAllAvailableCars();
 
-    if (availableCars.empty())
+    string startDate, endDate;
+    Date start, end;
+    bool validDates = false;
+
+    while (!validDates)
+    {
+        cout << "Enter start date (YYYY-MM-DD): ";
+        getline(cin, startDate);
+
+        cout << "Enter end date (YYYY-MM-DD): ";
+        getline(cin, endDate);
+
+        try
+        {
+            start = Date::parse(startDate);
+            end = Date::parse(endDate);
+            if (end <= start)
+            {
+                cout << "Error: End date must be after start date.\n";
+                continue;
+            }
+            if (start < Date::today())
+            {
+                cout << "Error: Start date cannot be in the past.\n";
+                continue;
+            }
+            validDates = true;
+        }
+        catch (const runtime_error &e)
+        {
+            cout << e.what() << endl;
+            cout << "Please use the format YYYY-MM-DD (e.g., 2024-03-15)\n";
+        }
+    }
+
+    CarQuery query;
+    query.startDay = start.dayNumber();
+    query.endDay = end.dayNumber();
+    CarPage availableCars = system.findCars(query);
+
+    if (availableCars.cars.empty())
     {
-        cout << "No cars available for booking at the moment.\n";
+        cout << "No cars available for those dates.\n";
         return;
     }
 
-    cout << "Available Cars:\n";
+    cout << "Cars Available from " << startDate << " to " << endDate << ":\n";
     cout << "========================================\n";
-    for (const auto &car : availableCars)
+    for (const Car &car : availableCars.cars)
     {
         car.display();
         cout << "----------------------------------------\n";
     }
 
+    // A copy: the fleet may change while the customer decides, and addBooking checks
+    // the car and its dates again under the lock
     int carId;
-    Car *selectedCar = nullptr;
+    optional<Car> selectedCar;
 
     while (true)
     {
@@ -2297,13 +6029,13 @@ void Customer::bookCar(CarRentalSystem &system)
 
         try
         {
-            Car &car = system.getCarById(carId);
-            if (!car.isAvailable())
+            Car car = system.getCarById(carId);
+            if (!system.isCarFree(carId, start.dayNumber(), end.dayNumber()))
             {
-                cout << "Sorry, this car is no longer available. Please choose another car.\n";
+                cout << "Sorry, this car is not available for those dates. Please choose another car.\n";
                 continue;
             }
-            selectedCar = &car;
+            selectedCar = car;
             break;
         }
         catch (const CarNotFoundException &e)
@@ -2322,35 +6054,7 @@ void Customer::bookCar(CarRentalSystem &system)
     selectedCar->display();
     cout << "----------------------------------------\n";
 
-    string startDate, endDate;
-    bool validDates = false;
-
-    while (!validDates)
-    {
-        cout << "Enter start date (YYYY-MM-DD): ";
-        getline(cin, startDate);
-
-        cout << "Enter end date (YYYY-MM-DD): ";
-        getline(cin, endDate);
-
-        try
-        {
-            int days = calculateDaysBetweenDates(startDate, endDate);
-            if (days <= 0)
-            {
-                cout << "Error: End date must be after start date.\n";
-                continue;
-            }
-            validDates = true;
-        }
-        catch (const runtime_error &e)
-        {
-            cout << e.what() << endl;
-            cout << "Please use the format YYYY-MM-DD (e.g., 2024-03-15)\n";
-        }
-    }
-
-    int rentalDays = calculateDaysBetweenDates(startDate, endDate);
+    int rentalDays = end - start;
     double totalPrice = selectedCar->getPricePerDay() * rentalDays;
 
     // Show booking summary and confirm
@@ -2372,14 +6076,18 @@ void Customer::bookCar(CarRentalSystem &system)
         return;
     }
 
-    int bookingId = generateRandomId();
-    Booking newBooking(bookingId, this->id, selectedCar->getId(), startDate, endDate, totalPrice);
-    bookings.push_back(newBooking);
-    system.addBooking(newBooking);
-
-    // Update car status to "Pending Approval"
-    selectedCar->setStatus("Pending Approval");
-    system.saveCarData(); // Save the updated car status
+    int bookingId;
+    try
+    {
+        bookingId = system.newBookingId(); // May have to persist a new id block
+        Booking newBooking(bookingId, this->id, selectedCar->getId(), start, end, totalPrice);
+        system.addBooking(newBooking); // Reserves the dates on the car
+    }
+    catch (const exception &e)
+    {
+        cout << "Error: " << e.what() << endl;
+        return;
+    }
 
     cout << "\nBooking created successfully!\n";
     cout << "Booking ID: " << bookingId << "\n";
@@ -2390,44 +6098,26 @@ void Customer::bookCar(CarRentalSystem &system)
 void Customer::viewBookings() const
 {
     cout << "\n--- My Bookings ---\n";
-    if (bookings.empty())
+    const CarRentalSystem *system = CarRentalSystem::getInstance();
+    if (system->countUserBookings(id) == 0)
     {
         cout << "No bookings found.\n";
         return;
     }
 
-    CarRentalSystem *system = CarRentalSystem::getInstance();
-    const auto &systemBookings = system->getAllBookings();
-
-    for (const auto &booking : bookings)
-    {
-        // Find the corresponding system booking to get the latest status
-        auto it = find_if(systemBookings.begin(), systemBookings.end(),
-                          [&booking](const Booking &b)
-                          { return b.getId() == booking.getId(); });
-
-        if (it != systemBookings.end())
-        {
-            // Display with the latest status from the system
-            cout << "Booking ID: " << it->getId() << "\n";
-            cout << "Status: " << it->getStatus() << "\n";
-            cout << "Dates: " << it->getStartDate() << " to " << it->getEndDate() << "\n";
-            cout << "Total Price: $" << fixed << setprecision(2) << it->getTotalPrice() << "\n";
-            cout << "------------------------\n";
-        }
-        else
-        {
-            // Fallback to local booking data if not found in system
-            booking.display();
-            cout << "------------------------\n";
-        }
-    }
+    system->forEachUserBooking(id, [](const Booking &booking)
+                               {
+                                   cout << "Booking ID: " << booking.getId() << "\n";
+                                   cout << "Status: " << booking.getStatus() << "\n";
+                                   cout << "Dates: " << booking.getStartDate() << " to " << booking.getEndDate() << "\n";
+                                   cout << "Total Price: $" << fixed << setprecision(2) << booking.getTotalPrice() << "\n";
+                                   cout << "------------------------\n"; });
 }
 
 void Customer::cancelBooking(CarRentalSystem &system)
 {
     cout << "\n--- Cancel Booking ---\n";
-    if (bookings.empty())
+    if (system.countUserBookings(id) == 0)
     {
         cout << "No bookings to cancel.\n";
         return;
@@ -2439,29 +6129,31 @@ void Customer::cancelBooking(CarRentalSystem &system)
     cin >> bookingId;
     cin.ignore();
 
-    auto it = find_if(bookings.begin(), bookings.end(),
-                      [bookingId](const Booking &b)
-                      { return b.getId() == bookingId; });
-
-    if (it != bookings.end())
+    optional<Booking> booking = system.findBookingById(bookingId);
+    if (booking && booking->getUserId() == id)
     {
-        if (it->getStatus() == "Cancelled")
+        BookingStatus current = booking->getStatus();
+        if (current == BookingStatus::Cancelled)
         {
             cout << "This booking is already cancelled.\n";
             return;
         }
+        if (!canTransition(current, BookingStatus::Cancelled))
+        {
+            cout << "This booking can no longer be cancelled (status: " << current << ").\n";
+            return;
+        }
 
-        it->setStatus("Cancelled");
         try
         {
-            Car &car = system.getCarById(it->getCarId());
-            car.setAvailable(true);
-            cout << "Booking cancelled successfully.\n";
+            system.updateBookingStatus(bookingId, BookingStatus::Cancelled); // Frees the car for those dates
         }
-        catch (const CarNotFoundException &e)
+        catch (const InvalidTransitionException &e)
         {
-            cout << "Error: " << e.what() << endl;
+            cout << "Error: " << e.what() << endl; // An admin acted on it meanwhile
+            return;
         }
+        cout << "Booking cancelled successfully.\n";
     }
     else
     {
@@ -2473,14 +6165,19 @@ void Customer::viewRentalHistory() const
 {
     cout << "\n--- Rental History ---\n";
 
-    if (bookings.empty())
+    const CarRentalSystem *system = CarRentalSystem::getInstance();
+    vector<Booking> sortedBookings;
+    sortedBookings.reserve(system->countUserBookings(id));
+    system->forEachUserBooking(id, [&sortedBookings](const Booking &booking)
+                               { sortedBookings.push_back(booking); });
+
+    if (sortedBookings.empty())
     {
         cout << "No rental history found.\n";
         return;
     }
 
     // Sort bookings by start date (newest first)
-    vector<Booking> sortedBookings = bookings;
     sort(sortedBookings.begin(), sortedBookings.end(),
          [](const Booking &a, const Booking &b)
          {
@@ -2490,22 +6187,17 @@ void Customer::viewRentalHistory() const
     cout << "You have " << sortedBookings.size() << " booking(s):\n";
     cout << "========================================\n";
 
-    for (const auto &booking : sortedBookings)
+    for (const Booking &booking : sortedBookings)
     {
         cout << "Booking ID: " << booking.getId() << "\n";
         cout << "Status: " << booking.getStatus() << "\n";
         cout << "Dates: " << booking.getStartDate() << " to " << booking.getEndDate() << "\n";
         cout << "Total Price: $" << fixed << setprecision(2) << booking.getTotalPrice() << "\n";
 
-        // Find corresponding payment if exists
-        auto paymentIt = find_if(payments.begin(), payments.end(),
-                                 [&booking](const Payment &p)
-                                 { return p.getBookingId() == booking.getId(); });
-
-        if (paymentIt != payments.end())
+        if (optional<Payment> payment = system->findPaymentForBooking(booking.getId()))
         {
-            cout << "Payment Method: " << paymentIt->getMethod() << "\n";
-            cout << "Payment Status: " << paymentIt->getStatus() << "\n";
+            cout << "Payment Method: " << payment->getMethod() << "\n";
+            cout << "Payment Status: " << payment->getStatus() << "\n";
         }
         else
         {
@@ -2519,26 +6211,22 @@ void Customer::viewRentalHistory() const
 void Customer::makePayment()
 {
     cout << "\n--- Make Payment ---\n";
-    if (bookings.empty())
+    CarRentalSystem *system = CarRentalSystem::getInstance();
+    if (system->countUserBookings(id) == 0)
     {
         cout << "No bookings requiring payment.\n";
         return;
     }
 
     // Show approved bookings that haven't been paid
-    vector<const Booking *> payableBookings;
-    for (const auto &booking : bookings)
-    {
-        // Check if booking is approved and hasn't been paid yet
-        bool isPaid = any_of(payments.begin(), payments.end(),
-                             [&booking](const Payment &payment)
-                             { return payment.getBookingId() == booking.getId(); });
-
-        if (booking.getStatus() == "Approved" && !isPaid)
-        {
-            payableBookings.push_back(&booking);
-        }
-    }
+    // Copies: addPayment checks again under the lock that each is still approved and unpaid
+    vector<Booking> payableBookings;
+    system->forEachUserBookingWithStatus(id, BookingStatus::Approved, [system, &payableBookings](const Booking &booking)
+                                         {
+                                             if (!system->findPaymentForBooking(booking.getId()))
+                                             {
+                                                 payableBookings.push_back(booking);
+                                             } });
 
     if (payableBookings.empty())
     {
@@ -2551,7 +6239,7 @@ void Customer::makePayment()
     cout << "===================================\n";
     for (const auto &booking : payableBookings)
     {
-        booking->display();
+        booking.display();
         cout << "----------------------------------\n";
     }
 
@@ -2569,9 +6257,9 @@ void Customer::makePayment()
     const Booking *selectedBooking = nullptr;
     for (const auto &booking : payableBookings)
     {
-        if (booking->getId() == bookingId)
+        if (booking.getId() == bookingId)
         {
-            selectedBooking = booking;
+            selectedBooking = &booking;
             break;
         }
     }
@@ -2631,21 +6319,28 @@ void Customer::makePayment()
         return;
     }
 
+    // Record the payment first: the booking may have been paid or cancelled since it was listed
+    optional<Payment> payment;
+    try
+    {
+        payment.emplace(system->newPaymentId(), bookingId, selectedBooking->getTotalPrice(), method);
+        system->addPayment(*payment);
+    }
+    catch (const exception &e)
+    {
+        cout << "Payment not accepted: " << e.what() << "\n";
+        return;
+    }
+
     cout << "\nProcessing payment of $" << fixed << setprecision(2)
          << selectedBooking->getTotalPrice() << "...\n";
     strategy->pay(selectedBooking->getTotalPrice());
 
-    // Record payment
-    int paymentId = generateRandomId();
-    Payment payment(paymentId, bookingId, selectedBooking->getTotalPrice(), method);
-    payments.push_back(payment);
-
     // Log the transaction
     try
     {
-        CarRentalSystem *system = CarRentalSystem::getInstance();
-        Car &car = system->getCarById(selectedBooking->getCarId());
-        Logger::getInstance()->logTransaction(username, email, car, *selectedBooking, payment);
+        Car car = system->getCarById(selectedBooking->getCarId());
+        Logger::getInstance()->logTransaction(username, email, car, *selectedBooking, *payment);
     }
     catch (const exception &e)
     {
@@ -2653,7 +6348,7 @@ void Customer::makePayment()
     }
 
     cout << "\nPayment completed successfully!\n";
-    cout << "Payment ID: " << paymentId << "\n";
+    cout << "Payment ID: " << payment->getId() << "\n";
     cout << "Method: " << method << "\n";
     cout << "Amount Paid: $" << fixed << setprecision(2) << selectedBooking->getTotalPrice() << "\n";
 }
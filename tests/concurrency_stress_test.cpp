@@ -0,0 +1,261 @@
+// Concurrency stress test, meant to run under ThreadSanitizer. One thread drives the customer
+// and admin menus (search, book, pay, cancel, approve, update price) with scripted input
+// while others change prices, add and remove cars, and book, approve, pay and cancel
+// through the system API, logging as they go while the report totals are rebuilt. Afterwards
+// no car may be double-booked, every Paid booking must have exactly the payment the index
+// reports, and the running report totals must match a rebuild from the logs.
+// Build: g++ -std=c++17 -O1 -g -fsanitize=thread -pthread -DCAR_RENTAL_NO_MAIN
+//        tests/concurrency_stress_test.cpp -o concurrency_stress_test
+// Run it from an empty directory: the system reads and writes its data files there.
+#include <cstdlib>
+
+#include "../merged_project.cpp"
+
+// Swallows the menus' output
+class NullBuffer : public streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+};
+
+int failures = 0;
+
+void check(bool ok, const string &what)
+{
+    if (!ok)
+    {
+        cerr << "FAIL: " << what << endl;
+        ++failures;
+    }
+}
+
+// Runs one menu action with its own input, so an early return cannot shift later answers
+template <typename Fn>
+void withInput(const string &input, Fn action)
+{
+    istringstream script(input);
+    streambuf *previous = cin.rdbuf(script.rdbuf());
+    action();
+    cin.rdbuf(previous);
+}
+
+int newestBooking(const CarRentalSystem &system, int userId, int carId)
+{
+    int newest = 0;
+    system.forEachUserBooking(userId, [&newest, carId](const Booking &booking)
+                              {
+                                  if (booking.getCarId() == carId)
+                                  {
+                                      newest = max(newest, booking.getId());
+                                  } });
+    return newest;
+}
+
+vector<int> bookingsWithStatus(const CarRentalSystem &system, BookingStatus status)
+{
+    vector<int> bookingIds;
+    system.forEachBookingWithStatus(status, [&bookingIds](const Booking &booking)
+                                    { bookingIds.push_back(booking.getId()); });
+    return bookingIds;
+}
+
+// Customer and admin menus on car 1, which the other threads never book or take out of service
+void driveMenus(CarRentalSystem &system, Customer &customer, Admin &admin, int firstDay, int rounds)
+{
+    for (int round = 0; round < rounds; ++round)
+    {
+        string start = Date(firstDay + 3 * round).toString();
+        string end = Date(firstDay + 3 * round + 2).toString();
+        withInput("4\n", [&]
+                  { customer.searchCars(system); });
+        withInput("5\n" + start + "\n" + end + "\n", [&]
+                  { customer.searchCars(system); });
+        withInput(start + "\n" + end + "\n1\ny\n", [&]
+                  { customer.bookCar(system); });
+        int bookingId = newestBooking(system, customer.getId(), 1);
+        if (round % 3 == 0)
+        {
+            withInput(to_string(bookingId) + "\n", [&]
+                      { customer.cancelBooking(system); });
+        }
+        withInput("3\n" + to_string(bookingId) + "\n1\n\n\n0\n", [&]
+                  { admin.manageBookings(system); });
+        withInput(to_string(bookingId) + "\n" + to_string(1 + round % 3) + "\n", [&]
+                  { customer.makePayment(); });
+        withInput(to_string(bookingId) + "\n", [&]
+                  { customer.cancelBooking(system); });
+        withInput("1\n" + to_string(40 + round % 20) + "\n", [&]
+                  { admin.updateCar(system); });
+        customer.viewRentalHistory();
+    }
+}
+
+// Approves or cancels whatever is pending, racing the menus, and pays for bookings on the
+// other cars (car 1 is left to the payment menu). Rebuilds the report totals now and then.
+void settleBookings(CarRentalSystem &system, int rounds)
+{
+    for (int round = 0; round < rounds; ++round)
+    {
+        if (round % 20 == 0)
+        {
+            Logger::getInstance()->rebuildReportAggregates();
+        }
+        for (int bookingId : bookingsWithStatus(system, BookingStatus::Pending))
+        {
+            try
+            {
+                system.updateBookingStatus(bookingId, bookingId % 4 ? BookingStatus::Approved : BookingStatus::Cancelled);
+            }
+            catch (const exception &)
+            {
+            }
+        }
+        for (int bookingId : bookingsWithStatus(system, BookingStatus::Approved))
+        {
+            optional<Booking> booking = system.findBookingById(bookingId);
+            if (booking && booking->getCarId() != 1)
+            {
+                try
+                {
+                    system.addPayment(Payment(system.newPaymentId(), bookingId, booking->getTotalPrice(), "Cash"));
+                }
+                catch (const exception &)
+                {
+                }
+            }
+        }
+        this_thread::yield();
+    }
+}
+
+// Bookings on cars 2-4, half of them for days another thread also wants
+void bookCars(CarRentalSystem &system, int userId, int firstDay, int rounds)
+{
+    for (int round = 0; round < rounds; ++round)
+    {
+        int carId = 2 + round % 3;
+        int start = firstDay + round / 2;
+        Booking booking(system.newBookingId(), userId, carId, Date(start), Date(start + 2), 10.0);
+        try
+        {
+            system.addBooking(booking);
+            Logger::getInstance()->logBookingUpdate("user" + to_string(userId), "Booked", booking,
+                                                    system.getCarById(carId));
+            if (round % 5 == 0)
+            {
+                system.updateBookingStatus(booking.getId(), BookingStatus::Cancelled);
+            }
+        }
+        catch (const exception &)
+        {
+        }
+    }
+}
+
+// Price changes on the whole sample fleet, and short-lived cars coming and going
+void churnFleet(CarRentalSystem &system, int rounds)
+{
+    for (int round = 0; round < rounds; ++round)
+    {
+        system.updateCarPrice(1 + round % 4, 30.0 + round % 50);
+        CarQuery query;
+        query.keyword = "o";
+        query.sortBy = CarQuery::SortBy::Price;
+        for (const Car &car : system.findCars(query).cars)
+        {
+            check(car.getPricePerDay() > 0, "price read from a search page");
+        }
+        if (round % 10 == 0)
+        {
+            int carId = system.getNextCarId();
+            system.addCar(Car(carId, "Tesla", "Model3", "Sedan", 2024, "Red", 99, "TS" + to_string(carId)));
+            system.updateCarStatus(carId, CarStatus::Maintenance);
+            system.updateCarPrice(carId, 88);
+            system.removeCar(carId);
+        }
+    }
+}
+
+void checkInvariants(const CarRentalSystem &system)
+{
+    map<int, vector<pair<int, int>>> heldDays; // car id -> [start, end) of bookings holding it
+    for (BookingStatus status : {BookingStatus::Pending, BookingStatus::Approved, BookingStatus::Paid})
+    {
+        system.forEachBookingWithStatus(status, [&](const Booking &booking)
+                                        {
+                                            heldDays[booking.getCarId()].push_back(
+                                                {booking.getStartDate().dayNumber(), booking.getEndDate().dayNumber()});
+                                            bool paid = system.findPaymentForBooking(booking.getId()).has_value();
+                                            check(paid == (status == BookingStatus::Paid),
+                                                  "payment of booking " + to_string(booking.getId()));
+                                        });
+    }
+    for (auto &[carId, ranges] : heldDays)
+    {
+        sort(ranges.begin(), ranges.end());
+        for (size_t i = 1; i < ranges.size(); ++i)
+        {
+            check(ranges[i - 1].second <= ranges[i].first, "car " + to_string(carId) + " double-booked");
+        }
+    }
+}
+
+// Totals kept up as events were logged must equal a fold of the logs themselves
+void checkReportTotals()
+{
+    Logger &logger = *Logger::getInstance();
+    ReportAggregates running = logger.getReportAggregates();
+    logger.rebuildReportAggregates();
+    ReportAggregates rebuilt = logger.getReportAggregates();
+    auto counts = [](const map<string, GroupTotals> &groups)
+    {
+        map<string, int> result;
+        for (const auto &[key, totals] : groups)
+        {
+            result[key] = totals.count;
+        }
+        return result;
+    };
+    check(counts(running.byStatus) == counts(rebuilt.byStatus), "report status counts match the logs");
+    check(counts(running.byMethod) == counts(rebuilt.byMethod), "report payment counts match the logs");
+    check(abs(running.totalRevenue - rebuilt.totalRevenue) < 0.01, "report revenue matches the logs");
+}
+
+int main()
+{
+    setenv("TERM", "dumb", 1); // manageBookings clears the screen
+    CarRentalSystem &system = *CarRentalSystem::getInstance();
+    Admin *admin = dynamic_cast<Admin *>(system.findUserById(1));
+    Customer *customer = dynamic_cast<Customer *>(system.findUserById(2));
+    if (!admin || !customer)
+    {
+        cerr << "Run from an empty directory so the sample users are created" << endl;
+        return 1;
+    }
+
+    NullBuffer discard;
+    streambuf *console = cout.rdbuf(&discard);
+    int today = Date::today().dayNumber();
+    vector<thread> threads;
+    threads.emplace_back(driveMenus, ref(system), ref(*customer), ref(*admin), today + 10, 30);
+    threads.emplace_back(settleBookings, ref(system), 200);
+    threads.emplace_back(bookCars, ref(system), 2, today + 10, 300);
+    threads.emplace_back(bookCars, ref(system), 3, today + 10, 300);
+    threads.emplace_back(churnFleet, ref(system), 300);
+    for (thread &worker : threads)
+    {
+        worker.join();
+    }
+    cout.rdbuf(console);
+
+    checkInvariants(system);
+    checkReportTotals();
+    Logger::getInstance()->shutdown();
+    if (failures)
+    {
+        cerr << failures << " check(s) failed" << endl;
+        return 1;
+    }
+    cout << "concurrency_stress_test: all checks passed" << endl;
+    return 0;
+}
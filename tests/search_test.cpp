@@ -0,0 +1,160 @@
+// Fuzzy search regression checks: the trigram filter must find exactly what a brute-force
+// edit-distance scan finds, including needles made of one repeated letter, and keep doing
+// so as cars are removed and their terms freed and reused.
+// Build: g++ -std=c++17 -O1 -g -D_GLIBCXX_ASSERTIONS -fsanitize=address,undefined -pthread
+//        -DCAR_RENTAL_NO_MAIN tests/search_test.cpp -o search_test
+#include <random>
+#include <set>
+
+#include "../merged_project.cpp"
+
+int failures = 0;
+
+void check(bool ok, const string &what)
+{
+    if (!ok)
+    {
+        cerr << "FAIL: " << what << endl;
+        ++failures;
+    }
+}
+
+// Term ids double as car ids, so the matched terms are the ids forMatches reports
+set<int> indexed(const TermIndex &index, const string &needle)
+{
+    set<int> found;
+    index.forMatches(needle, true, [&found](const vector<int> &ids)
+                     { found.insert(ids.begin(), ids.end()); });
+    return found;
+}
+
+// An empty entry stands for a removed car
+set<int> bruteForce(const vector<string> &terms, const string &needle, size_t editCap)
+{
+    set<int> found;
+    for (size_t id = 0; id < terms.size(); ++id)
+    {
+        if (!terms[id].empty() && textMatches(terms[id], needle, true, editCap))
+        {
+            found.insert(static_cast<int>(id));
+        }
+    }
+    return found;
+}
+
+void checkTermIndex(size_t editCap)
+{
+    mt19937 rng(7);
+    vector<string> terms = {"aaaaaa", "aaaaab", "aaaa", "aaaaaaaa", "baaaaa", "hahaha", "haha", "hahahaha",
+                            "ahahah", "zzzzzzzz", "zzzzzzz", "zzzzzzzzzz", "zzzz", "toyota", "honda"};
+    // A small alphabet produces many repeated trigrams and near misses
+    while (terms.size() < 3000)
+    {
+        string term;
+        size_t length = 3 + rng() % 8;
+        for (size_t i = 0; i < length; ++i)
+        {
+            term += "ahz"[rng() % 3];
+        }
+        terms.push_back(term);
+    }
+    TermIndex index(editCap);
+    for (size_t id = 0; id < terms.size(); ++id)
+    {
+        index.add(static_cast<int>(id), terms[id]);
+    }
+
+    vector<string> needles = {"aaaaaa", "hahaha", "zzzzzzzz", "aaa", "aaaaaaaaaaaa", "zzzzz", "hhhhhh", "toyta"};
+    for (int i = 0; i < 300; ++i)
+    {
+        needles.push_back(terms[rng() % terms.size()]);
+        string needle = needles.back();
+        needle[rng() % needle.size()] = "ahz"[rng() % 3];
+        needles.push_back(needle);
+    }
+    vector<string> live = terms;
+    auto checkAll = [&](const string &stage)
+    {
+        for (const string &needle : needles)
+        {
+            check(indexed(index, needle) == bruteForce(live, needle, editCap),
+                  stage + "fuzzy '" + needle + "' with at most " + to_string(editCap) + " edits");
+        }
+    };
+    checkAll("");
+
+    // Remove two cars in three, then bring half of those back so freed term ids get reused
+    for (size_t id = 0; id < terms.size(); ++id)
+    {
+        if (id % 3 != 0)
+        {
+            index.remove(static_cast<int>(id), terms[id]);
+            live[id].clear();
+        }
+    }
+    checkAll("after removals: ");
+    for (size_t id = 0; id < terms.size(); ++id)
+    {
+        if (id % 3 == 1)
+        {
+            index.add(static_cast<int>(id), terms[id]);
+            live[id] = terms[id];
+        }
+    }
+    checkAll("after re-adding: ");
+
+    for (size_t id = 0; id < terms.size(); ++id)
+    {
+        index.remove(static_cast<int>(id), terms[id]);
+    }
+    check(index.termCount() == 0, "terms freed once their last car is removed");
+}
+
+void checkCarSearch()
+{
+    CarSearchIndex index;
+    index.add(Car(1, "Aaaaaa", "Model1", "Sedan", 2020, "Black", 50, "AAA111"));
+    index.add(Car(2, "Aaaaab", "Hahaha", "SUV", 2021, "White", 60, "ZZZ999"));
+    index.add(Car(3, "Toyota", "Corolla", "Sedan", 2019, "Red", 40, "HAH123"));
+
+    for (const string &needle : {"aaaaaa", "AAAAAA", "hahaha", "zzzzzzzz"})
+    {
+        CarQuery query;
+        query.brand = needle;
+        query.fuzzy = true;
+        vector<int> carIds;
+        index.candidates(query, carIds, numeric_limits<size_t>::max());
+        sort(carIds.begin(), carIds.end());
+        vector<int> expected;
+        if (needle == string("aaaaaa") || needle == string("AAAAAA"))
+        {
+            expected = {1, 2};
+        }
+        check(carIds == expected, string("brand fuzzy '") + needle + "'");
+
+        query.brand.clear();
+        query.keyword = needle;
+        carIds.clear();
+        index.candidates(query, carIds, numeric_limits<size_t>::max());
+        sort(carIds.begin(), carIds.end());
+        if (needle == string("hahaha"))
+        {
+            expected = {2};
+        }
+        check(carIds == expected, string("keyword fuzzy '") + needle + "'");
+    }
+}
+
+int main()
+{
+    checkTermIndex(2);
+    checkTermIndex(1);
+    checkCarSearch();
+    if (failures)
+    {
+        cerr << failures << " check(s) failed" << endl;
+        return 1;
+    }
+    cout << "search_test: all checks passed" << endl;
+    return 0;
+}